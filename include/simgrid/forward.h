@@ -77,6 +77,7 @@ namespace activity {
   using SleepImplPtr = boost::intrusive_ptr<SleepImpl>;
 
   class MailboxImpl;
+  struct MatchDescriptor;
 }
 namespace context {
 class Context;
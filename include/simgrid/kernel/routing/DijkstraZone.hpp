@@ -7,12 +7,9 @@
 #define SURF_ROUTING_DIJKSTRA_HPP_
 
 #include <simgrid/kernel/routing/RoutedZone.hpp>
+#include <xbt/xbt_os_thread.h>
 
-struct s_graph_node_data_t {
-  int id;
-  int graph_id; /* used for caching internal graph id's */
-};
-typedef s_graph_node_data_t* graph_node_data_t;
+#include <unordered_set>
 
 namespace simgrid {
 namespace kernel {
@@ -34,12 +31,6 @@ namespace routing {
 class XBT_PRIVATE DijkstraZone : public RoutedZone {
 public:
   DijkstraZone(NetZone* father, std::string name, bool cached);
-  void seal() override;
-
-  ~DijkstraZone() override;
-  xbt_node_t routeGraphNewNode(int id, int graph_id);
-  xbt_node_t nodeMapSearch(int id);
-  void newRoute(int src_id, int dst_id, RouteCreationArgs* e_route);
   /* For each vertex (node) already in the graph,
    * make sure it also has a loopback link; this loopback
    * can potentially already be in the graph, and in that
@@ -51,14 +42,39 @@ public:
    * After this function returns, any node in the graph
    * will have a loopback attached to it.
    */
+  void seal() override;
+
+  ~DijkstraZone() override;
   void get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* route, double* lat) override;
   void add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
                  std::vector<resource::LinkImpl*>& link_list, bool symmetrical) override;
 
-  xbt_graph_t route_graph_ = nullptr;          /* xbt_graph */
-  std::map<int, xbt_node_t> graph_node_map_;   /* map */
-  bool cached_;                                /* cache mode */
-  std::map<int, std::vector<int>> route_cache_; /* use in cache mode */
+private:
+  struct Edge {
+    unsigned src;   // graph node
+    unsigned dst;   // graph node
+    unsigned cost;  // count of links, old model assume 1
+    unsigned route; // index in routes_
+  };
+
+  int get_node(NetPoint* netpoint);
+  unsigned new_node(NetPoint* netpoint);
+  int find_edge(unsigned src, unsigned dst);
+  void new_edge(unsigned src, unsigned dst, RouteCreationArgs* e_route);
+  void build_graph();
+  void compute_predecessors(unsigned src, std::vector<int>& pred_edge) const;
+  void precompute_predecessors(unsigned nthreads);
+
+  bool cached_; /* cache mode */
+  RouteStore routes_;
+  std::vector<int> graph_node_of_; /* graph node of each netpoint id, or -1 */
+  unsigned node_count_ = 0;
+  std::vector<Edge> edges_;                               /* in declaration order */
+  std::unordered_set<unsigned long long> declared_edges_; /* (src, dst) of the edges, until the graph is built */
+  std::vector<unsigned> out_begin_; /* the out edges of node n are out_edges_[out_begin_[n]..out_begin_[n+1]) */
+  std::vector<unsigned> out_edges_; /* edge indexes, sorted by source node */
+  std::vector<std::vector<int>> route_cache_; /* use in cache mode: for each source, the edge reaching each node */
+  xbt_os_mutex_t cache_mutex_;
 };
 } // namespace routing
 } // namespace kernel
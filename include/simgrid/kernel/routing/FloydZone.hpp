@@ -24,7 +24,6 @@ namespace routing {
 class XBT_PRIVATE FloydZone : public RoutedZone {
 public:
   explicit FloydZone(NetZone* father, std::string name);
-  ~FloydZone() override;
 
   void get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* into, double* latency) override;
   void add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
@@ -32,10 +31,23 @@ public:
   void seal() override;
 
 private:
-  /* vars to compute the Floyd algorithm. */
-  int* predecessor_table_;
-  double* cost_table_;
-  RouteCreationArgs** link_table_;
+  int get_predecessor(unsigned src, unsigned dst) const;
+  void compress_predecessors(const std::vector<int>& predecessor_table);
+
+  /* The predecessors computed by the Floyd algorithm, stored by column (destination). Most sources share the same
+   * predecessor for a given destination: only the sources that differ from it are stored, unless they are so many
+   * that the full column is smaller. */
+  struct PredecessorColumn {
+    int common_pred;   // predecessor of the sources that are not listed
+    bool dense;        // whether the column is stored in full in pred_dense_ rather than in pred_sparse_
+    std::size_t begin; // range of the column in pred_dense_ or pred_sparse_
+    std::size_t end;
+  };
+  std::vector<PredecessorColumn> pred_columns_;
+  std::vector<unsigned long long> pred_sparse_; // (src << 32 | pred), sorted by src in each column
+  std::vector<int> pred_dense_;
+  RouteStore routes_;
+  std::unordered_map<unsigned long long, unsigned> link_table_; // (src, dst) -> index in routes_ of the 1-hop routes
 };
 } // namespace routing
 } // namespace kernel
@@ -16,20 +16,21 @@ namespace routing {
  *  @brief NetZone with an explicit routing provided by the user
  *
  *  The full communication matrix is provided at creation, so this model has the highest expressive power and the lowest
- *  computational requirements, but also the highest memory requirements (both in platform file and in memory).
+ *  computational requirements, but also the highest memory requirements (both in platform file and in memory). In
+ *  memory, the matrix only holds 32-bit indices of the distinct routes, whose common suffixes are shared.
  */
 class XBT_PRIVATE FullZone : public RoutedZone {
 public:
   explicit FullZone(NetZone* father, std::string name);
   void seal() override;
-  ~FullZone() override;
 
   void get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* into, double* latency) override;
   void add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
                  std::vector<resource::LinkImpl*>& link_list, bool symmetrical) override;
 
 private:
-  RouteCreationArgs** routing_table_ = nullptr;
+  RouteStore routes_;
+  std::vector<unsigned> routing_table_; // index of the route in routes_ + 1, or 0 if no route
 };
 } // namespace routing
 } // namespace kernel
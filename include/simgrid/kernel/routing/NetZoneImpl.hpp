@@ -76,6 +76,10 @@ protected:
   bool get_bypass_route(routing::NetPoint* src, routing::NetPoint* dst,
                         /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency);
 
+private:
+  static void resolve_global_route(routing::NetPoint* src, routing::NetPoint* dst,
+                                   /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency);
+
 public:
   /* @brief get the route between two nodes in the full platform
    *
@@ -87,6 +91,13 @@ public:
   static void get_global_route(routing::NetPoint* src, routing::NetPoint* dst,
                                /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency);
 
+  /** @brief Forget all the routes kept in the route cache, e.g. because the platform changed */
+  static void invalidate_route_cache();
+  /** @brief Amount of routes found in the route cache so far */
+  static unsigned long get_route_cache_hits();
+  /** @brief Amount of routes that had to be computed because they were not in the route cache */
+  static unsigned long get_route_cache_misses();
+
   virtual void get_graph(xbt_graph_t graph, std::map<std::string, xbt_node_t>* nodes,
                          std::map<std::string, xbt_edge_t>* edges) = 0;
   enum class RoutingMode {
@@ -8,10 +8,55 @@
 
 #include <simgrid/kernel/routing/NetZoneImpl.hpp>
 
+#include <tuple>
+#include <unordered_map>
+
 namespace simgrid {
 namespace kernel {
 namespace routing {
 
+/** @brief Compact storage of the routes of a netzone
+ *
+ * The routes are designated by 32-bit indices. Identical routes (same gateways and same links) are stored only once,
+ * and the link sequences are stored as chains of hops that share their common suffixes: adding a route that ends like
+ * an already known one only stores its new prefix.
+ */
+class XBT_PRIVATE RouteStore {
+public:
+  /** @brief Stores the route (if not already known) and returns its index */
+  unsigned add(const RouteCreationArgs& route);
+  NetPoint* get_gw_src(unsigned route) const { return routes_[route].gw_src; }
+  NetPoint* get_gw_dst(unsigned route) const { return routes_[route].gw_dst; }
+  /** @brief Appends the links of the route to the given vector, adding their latency to *latency if not null */
+  void get_links(unsigned route, std::vector<resource::LinkImpl*>& links, double* latency) const;
+  /** @brief Returns the number of links of the route */
+  unsigned get_size(unsigned route) const;
+  /** @brief Forgets the indexes used to share the routes, once no new route is expected */
+  void shrink();
+
+private:
+  struct Hop {
+    resource::LinkImpl* link;
+    unsigned next; // index of the next hop + 1, or 0 at the end of the route
+  };
+  struct Route {
+    unsigned first; // index of the first hop + 1, or 0 for an empty route
+    NetPoint* gw_src;
+    NetPoint* gw_dst;
+  };
+  typedef std::pair<resource::LinkImpl*, unsigned> HopKey;
+  typedef std::tuple<unsigned, NetPoint*, NetPoint*> RouteKey;
+  struct KeyHash {
+    std::size_t operator()(const HopKey& key) const;
+    std::size_t operator()(const RouteKey& key) const;
+  };
+
+  std::vector<Hop> hops_;
+  std::vector<Route> routes_;
+  std::unordered_map<HopKey, unsigned, KeyHash> hop_index_;
+  std::unordered_map<RouteKey, unsigned, KeyHash> route_index_;
+};
+
 /** @ingroup ROUTING_API
  *  @brief NetZone with an explicit routing (abstract class)
  *
@@ -32,8 +77,8 @@ namespace routing {
  * </tr>
  * <tr><td><b>Memory usage</b></td>
  * <td>1-hop routes (+ cache of routes)</td>
- * <td>O(n^2) data (intermediate)</td>
- * <td>O(n^2) + sum of path lengths (very large)</td>
+ * <td>O(n^2) data while sealing, then the uncommon predecessors (intermediate)</td>
+ * <td>O(n^2) indices + distinct paths (very large)</td>
  * </tr>
  * <tr><td><b>Lookup time</b></td>
  * <td>Dijkstra Algo: O(n^3)</td>
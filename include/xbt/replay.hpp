@@ -22,6 +22,7 @@ typedef std::vector<std::string> ReplayAction;
 
 XBT_PUBLIC_DATA std::ifstream* action_fs;
 XBT_PUBLIC int replay_runner(int argc, char* argv[]);
+XBT_PUBLIC void replay_convert_to_binary(const char* text_file, const char* binary_file);
 }
 }
 
@@ -6,6 +6,7 @@
 #include "include/xbt/config.hpp"
 #include "simgrid/s4u/Engine.hpp"
 #include "src/instr/instr_private.hpp"
+#include "src/instr/instr_trace_writer.hpp"
 #include "surf/surf.hpp"
 #include "xbt/virtu.h" /* sg_cmdline */
 #include <fstream>
@@ -15,7 +16,8 @@
 XBT_LOG_NEW_CATEGORY(instr, "Logging the behavior of the tracing system (used for Visualization/Analysis of simulations)");
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY (instr_config, instr, "Configuration");
 
-std::ofstream tracing_file;
+std::ostream tracing_file(nullptr);
+static simgrid::instr::TraceWriter* tracing_writer = nullptr;
 
 #define OPT_TRACING_BASIC                "tracing/basic"
 #define OPT_TRACING_COMMENT_FILE         "tracing/comment-file"
@@ -101,24 +103,28 @@ static void TRACE_start()
 
     /* open the trace file(s) */
     std::string filename = TRACE_get_filename();
-    tracing_file.open(filename.c_str(), std::ofstream::out);
-    if (tracing_file.fail()) {
+    std::FILE* file      = std::fopen(filename.c_str(), "w");
+    if (file == nullptr) {
       THROWF(system_error, 1, "Tracefile %s could not be opened for writing.", filename.c_str());
     }
+    int buffer_size = simgrid::config::get_value<int>("tracing/buffer-size");
+    xbt_assert(buffer_size > 0, "The size of the trace buffers must be positive (got %d)", buffer_size);
+    tracing_writer = new simgrid::instr::TraceWriter(file, buffer_size);
+    tracing_file.rdbuf(tracing_writer);
 
     XBT_DEBUG("Filename %s is open for writing", filename.c_str());
 
     if (format == "Paje") {
       /* output generator version */
       tracing_file << "#This file was generated using SimGrid-" << SIMGRID_VERSION_MAJOR << "." << SIMGRID_VERSION_MINOR
-                   << "." << SIMGRID_VERSION_PATCH << std::endl;
+                   << "." << SIMGRID_VERSION_PATCH << "\n";
       tracing_file << "#[";
       unsigned int cpt;
       char* str;
       xbt_dynar_foreach (xbt_cmdline, cpt, str) {
         tracing_file << str << " ";
       }
-      tracing_file << "]" << std::endl;
+      tracing_file << "]" << "\n";
     }
 
     /* output one line comment */
@@ -153,7 +159,9 @@ static void TRACE_end()
   delete root_type;
 
   /* close the trace files */
-  tracing_file.close();
+  tracing_file.rdbuf(nullptr);
+  delete tracing_writer;
+  tracing_writer = nullptr;
   XBT_DEBUG("Filename %s is closed", TRACE_get_filename().c_str());
 
   /* de-activate trace */
@@ -289,6 +297,10 @@ void TRACE_global_init()
   simgrid::config::declare_flag<int>("tracing/precision", "Numerical precision used when timestamping events "
                                                           "(expressed in number of digits after decimal point)",
                                      6);
+  simgrid::config::declare_flag<int>("tracing/buffer-size",
+                                     "Size of the buffers in which the trace is formatted before being written to "
+                                     "disk by a separate thread (in bytes)",
+                                     1 << 20);
 
   /* Connect callbacks */
   simgrid::s4u::on_platform_creation.connect(TRACE_start);
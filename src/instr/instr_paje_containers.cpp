@@ -9,7 +9,7 @@
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY (instr_paje_containers, instr, "Paje tracing event system (containers)");
 
-extern std::ofstream tracing_file;
+extern std::ostream tracing_file;
 std::map<container_t, std::ofstream*> tracing_files; // TI specific
 double prefix = 0.0;                               // TI specific
 
@@ -155,7 +155,7 @@ void Container::log_creation()
     stream << std::fixed << std::setprecision(TRACE_precision()) << PAJE_CreateContainer << " ";
     stream << timestamp << " " << id_ << " " << type_->get_id() << " " << father_->id_ << " \"" << name_ << "\"";
     XBT_DEBUG("Dump %s", stream.str().c_str());
-    tracing_file << stream.str() << std::endl;
+    tracing_file << stream.str() << "\n";
   } else if (trace_format == simgrid::instr::TraceFormat::Ti) {
     // if we are in the mode with only one file
     static std::ofstream* ti_unique_file = nullptr;
@@ -175,7 +175,7 @@ void Container::log_creation()
 #endif
       ti_unique_file = new std::ofstream(filename.c_str(), std::ofstream::out);
       xbt_assert(not ti_unique_file->fail(), "Tracefile %s could not be opened for writing", filename.c_str());
-      tracing_file << filename << std::endl;
+      tracing_file << filename << "\n";
     }
     tracing_files.insert({this, ti_unique_file});
   } else {
@@ -194,7 +194,7 @@ void Container::log_destruction()
     stream << std::fixed << std::setprecision(TRACE_precision()) << PAJE_DestroyContainer << " ";
     stream << timestamp << " " << type_->get_id() << " " << id_;
     XBT_DEBUG("Dump %s", stream.str().c_str());
-    tracing_file << stream.str() << std::endl;
+    tracing_file << stream.str() << "\n";
   } else if (trace_format == simgrid::instr::TraceFormat::Ti) {
     if (not simgrid::config::get_value<bool>("tracing/smpi/format/ti-one-file") || tracing_files.size() == 1) {
       tracing_files.at(this)->close();
@@ -9,7 +9,7 @@
 #include "src/surf/surf_interface.hpp"
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(instr_paje_events, instr, "Paje tracing event system (events)");
-extern std::ofstream tracing_file;
+extern std::ostream tracing_file;
 extern std::map<container_t, std::ofstream*> tracing_files; // TI specific
 
 namespace simgrid {
@@ -26,13 +26,20 @@ PajeEvent::PajeEvent(Container* container, Type* type, double timestamp, e_event
   insert_into_buffer();
 };
 
+/** @brief Writes the formatted event as a line of the given trace file */
+void PajeEvent::dump(std::ostream& file)
+{
+  XBT_DEBUG("Dump %s", stream_.str().c_str());
+  file << stream_.str() << "\n";
+  xbt_assert(file.good(), "Error while writing the trace file");
+}
+
 void PajeEvent::print()
 {
   if (trace_format != simgrid::instr::TraceFormat::Paje)
     return;
 
-  XBT_DEBUG("Dump %s", stream_.str().c_str());
-  tracing_file << stream_.str() << std::endl;
+  dump(tracing_file);
 }
 
 StateEvent::StateEvent(Container* container, Type* type, e_event_type event_type, EntityValue* value, TIData* extra)
@@ -54,8 +61,7 @@ void NewEvent::print()
 
   stream_ << " " << value->get_id();
 
-  XBT_DEBUG("Dump %s", stream_.str().c_str());
-  tracing_file << stream_.str() << std::endl;
+  dump(tracing_file);
 }
 
 void LinkEvent::print()
@@ -68,8 +74,7 @@ void LinkEvent::print()
   if (TRACE_display_sizes())
     stream_ << " " << size_;
 
-  XBT_DEBUG("Dump %s", stream_.str().c_str());
-  tracing_file << stream_.str() << std::endl;
+  dump(tracing_file);
 }
 
 void VariableEvent::print()
@@ -79,8 +84,7 @@ void VariableEvent::print()
 
   stream_ << " " << value_;
 
-  XBT_DEBUG("Dump %s", stream_.str().c_str());
-  tracing_file << stream_.str() << std::endl;
+  dump(tracing_file);
 }
 
 void StateEvent::print()
@@ -98,8 +102,7 @@ void StateEvent::print()
       stream_ << " \"" << filename << "\" " << linenumber;
     }
 #endif
-    XBT_DEBUG("Dump %s", stream_.str().c_str());
-    tracing_file << stream_.str() << std::endl;
+    dump(tracing_file);
   } else if (trace_format == simgrid::instr::TraceFormat::Ti) {
     if (extra_ == nullptr)
       return;
@@ -113,7 +116,7 @@ void StateEvent::print()
       /* Subtract -1 because this is the process id and we transform it to the rank id */
       stream_ << stoi(get_container()->get_name().erase(0, 5)) - 1 << " " << extra_->print();
 
-    *tracing_files.at(get_container()) << stream_.str() << std::endl;
+    dump(*tracing_files.at(get_container()));
   } else {
     THROW_IMPOSSIBLE;
   }
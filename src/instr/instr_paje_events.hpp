@@ -42,6 +42,7 @@ class PajeEvent {
   Type* type_;
 protected:
   Container* get_container() { return container_; }
+  void dump(std::ostream& file);
 public:
   double timestamp_;
   e_event_type eventType_;
@@ -7,181 +7,181 @@
 #include "simgrid/sg_config.hpp"
 #include "src/instr/instr_private.hpp"
 
-extern std::ofstream tracing_file;
+extern std::ostream tracing_file;
 
 static void TRACE_header_PajeDefineContainerType(bool basic)
 {
-  tracing_file << "%EventDef PajeDefineContainerType " << simgrid::instr::PAJE_DefineContainerType << std::endl;
-  tracing_file << "%       Alias string" << std::endl;
+  tracing_file << "%EventDef PajeDefineContainerType " << simgrid::instr::PAJE_DefineContainerType << "\n";
+  tracing_file << "%       Alias string" << "\n";
   if (basic){
-    tracing_file << "%       ContainerType string" << std::endl;
+    tracing_file << "%       ContainerType string" << "\n";
   }else{
-    tracing_file << "%       Type string" << std::endl;
+    tracing_file << "%       Type string" << "\n";
   }
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeDefineVariableType(bool basic)
 {
-  tracing_file << "%EventDef PajeDefineVariableType " << simgrid::instr::PAJE_DefineVariableType << std::endl;
-  tracing_file << "%       Alias string" << std::endl;
+  tracing_file << "%EventDef PajeDefineVariableType " << simgrid::instr::PAJE_DefineVariableType << "\n";
+  tracing_file << "%       Alias string" << "\n";
   if (basic){
-    tracing_file << "%       ContainerType string" << std::endl;
+    tracing_file << "%       ContainerType string" << "\n";
   }else{
-    tracing_file << "%       Type string" << std::endl;
+    tracing_file << "%       Type string" << "\n";
   }
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%       Color color" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%       Color color" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeDefineStateType(bool basic)
 {
-  tracing_file << "%EventDef PajeDefineStateType " << simgrid::instr::PAJE_DefineStateType << std::endl;
-  tracing_file << "%       Alias string" << std::endl;
+  tracing_file << "%EventDef PajeDefineStateType " << simgrid::instr::PAJE_DefineStateType << "\n";
+  tracing_file << "%       Alias string" << "\n";
   if (basic){
-    tracing_file << "%       ContainerType string" << std::endl;
+    tracing_file << "%       ContainerType string" << "\n";
   }else{
-    tracing_file << "%       Type string" << std::endl;
+    tracing_file << "%       Type string" << "\n";
   }
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeDefineEventType(bool basic)
 {
-  tracing_file << "%EventDef PajeDefineEventType " << simgrid::instr::PAJE_DefineEventType << std::endl;
-  tracing_file << "%       Alias string" << std::endl;
+  tracing_file << "%EventDef PajeDefineEventType " << simgrid::instr::PAJE_DefineEventType << "\n";
+  tracing_file << "%       Alias string" << "\n";
   if (basic){
-    tracing_file << "%       ContainerType string" << std::endl;
+    tracing_file << "%       ContainerType string" << "\n";
   }else{
-    tracing_file << "%       Type string" << std::endl;
+    tracing_file << "%       Type string" << "\n";
   }
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeDefineLinkType(bool basic)
 {
-  tracing_file << "%EventDef PajeDefineLinkType " << simgrid::instr::PAJE_DefineLinkType << std::endl;
-  tracing_file << "%       Alias string" << std::endl;
+  tracing_file << "%EventDef PajeDefineLinkType " << simgrid::instr::PAJE_DefineLinkType << "\n";
+  tracing_file << "%       Alias string" << "\n";
   if (basic){
-    tracing_file << "%       ContainerType string" << std::endl;
-    tracing_file << "%       SourceContainerType string" << std::endl;
-    tracing_file << "%       DestContainerType string" << std::endl;
+    tracing_file << "%       ContainerType string" << "\n";
+    tracing_file << "%       SourceContainerType string" << "\n";
+    tracing_file << "%       DestContainerType string" << "\n";
   }else{
-    tracing_file << "%       Type string" << std::endl;
-    tracing_file << "%       StartContainerType string" << std::endl;
-    tracing_file << "%       EndContainerType string" << std::endl;
+    tracing_file << "%       Type string" << "\n";
+    tracing_file << "%       StartContainerType string" << "\n";
+    tracing_file << "%       EndContainerType string" << "\n";
   }
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeDefineEntityValue(bool basic)
 {
-  tracing_file << "%EventDef PajeDefineEntityValue " << simgrid::instr::PAJE_DefineEntityValue << std::endl;
-  tracing_file << "%       Alias string" << std::endl;
+  tracing_file << "%EventDef PajeDefineEntityValue " << simgrid::instr::PAJE_DefineEntityValue << "\n";
+  tracing_file << "%       Alias string" << "\n";
   if (basic){
-    tracing_file << "%       EntityType string" << std::endl;
+    tracing_file << "%       EntityType string" << "\n";
   }else{
-    tracing_file << "%       Type string" << std::endl;
+    tracing_file << "%       Type string" << "\n";
   }
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%       Color color" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%       Color color" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeCreateContainer()
 {
-  tracing_file << "%EventDef PajeCreateContainer " << simgrid::instr::PAJE_CreateContainer << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Alias string" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeCreateContainer " << simgrid::instr::PAJE_CreateContainer << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Alias string" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeDestroyContainer()
 {
-  tracing_file << "%EventDef PajeDestroyContainer " << simgrid::instr::PAJE_DestroyContainer << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Name string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeDestroyContainer " << simgrid::instr::PAJE_DestroyContainer << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Name string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeSetVariable()
 {
-  tracing_file << "%EventDef PajeSetVariable " << simgrid::instr::PAJE_SetVariable << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value double" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeSetVariable " << simgrid::instr::PAJE_SetVariable << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value double" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeAddVariable()
 {
-  tracing_file << "%EventDef PajeAddVariable " << simgrid::instr::PAJE_AddVariable << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value double" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeAddVariable " << simgrid::instr::PAJE_AddVariable << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value double" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeSubVariable()
 {
-  tracing_file << "%EventDef PajeSubVariable " << simgrid::instr::PAJE_SubVariable << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value double" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeSubVariable " << simgrid::instr::PAJE_SubVariable << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value double" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeSetState()
 {
-  tracing_file << "%EventDef PajeSetState " << simgrid::instr::PAJE_SetState << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeSetState " << simgrid::instr::PAJE_SetState << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajePushState(int size)
 {
-  tracing_file << "%EventDef PajePushState " << simgrid::instr::PAJE_PushState << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value string" << std::endl;
+  tracing_file << "%EventDef PajePushState " << simgrid::instr::PAJE_PushState << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value string" << "\n";
   if (size)
-    tracing_file << "%       Size int" << std::endl;
+    tracing_file << "%       Size int" << "\n";
 #if HAVE_SMPI
   if (simgrid::config::get_value<bool>("smpi/trace-call-location")) {
     /**
      * paje currently (May 2016) uses "Filename" and "Linenumber" as
      * reserved words. We cannot use them...
      */
-    tracing_file << "%       Fname string" << std::endl;
-    tracing_file << "%       Lnumber int" << std::endl;
+    tracing_file << "%       Fname string" << "\n";
+    tracing_file << "%       Lnumber int" << "\n";
   }
 #endif
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajePopState()
 {
-  tracing_file << "%EventDef PajePopState " << simgrid::instr::PAJE_PopState << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajePopState " << simgrid::instr::PAJE_PopState << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeResetState(bool basic)
@@ -189,55 +189,55 @@ static void TRACE_header_PajeResetState(bool basic)
   if (basic)
     return;
 
-  tracing_file << "%EventDef PajeResetState " << simgrid::instr::PAJE_ResetState << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeResetState " << simgrid::instr::PAJE_ResetState << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeStartLink(bool basic, bool size)
 {
-  tracing_file << "%EventDef PajeStartLink " << simgrid::instr::PAJE_StartLink << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value string" << std::endl;
+  tracing_file << "%EventDef PajeStartLink " << simgrid::instr::PAJE_StartLink << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value string" << "\n";
   if (basic){
-    tracing_file << "%       SourceContainer string" << std::endl;
+    tracing_file << "%       SourceContainer string" << "\n";
   }else{
-    tracing_file << "%       StartContainer string" << std::endl;
+    tracing_file << "%       StartContainer string" << "\n";
   }
-  tracing_file << "%       Key string" << std::endl;
+  tracing_file << "%       Key string" << "\n";
   if (size)
-    tracing_file << "%       Size int" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+    tracing_file << "%       Size int" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeEndLink(bool basic)
 {
-  tracing_file << "%EventDef PajeEndLink " << simgrid::instr::PAJE_EndLink << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value string" << std::endl;
+  tracing_file << "%EventDef PajeEndLink " << simgrid::instr::PAJE_EndLink << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value string" << "\n";
   if (basic){
-    tracing_file << "%       DestContainer string" << std::endl;
+    tracing_file << "%       DestContainer string" << "\n";
   }else{
-    tracing_file << "%       EndContainer string" << std::endl;
+    tracing_file << "%       EndContainer string" << "\n";
   }
-  tracing_file << "%       Key string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%       Key string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 static void TRACE_header_PajeNewEvent()
 {
-  tracing_file << "%EventDef PajeNewEvent " << simgrid::instr::PAJE_NewEvent << std::endl;
-  tracing_file << "%       Time date" << std::endl;
-  tracing_file << "%       Type string" << std::endl;
-  tracing_file << "%       Container string" << std::endl;
-  tracing_file << "%       Value string" << std::endl;
-  tracing_file << "%EndEventDef" << std::endl;
+  tracing_file << "%EventDef PajeNewEvent " << simgrid::instr::PAJE_NewEvent << "\n";
+  tracing_file << "%       Time date" << "\n";
+  tracing_file << "%       Type string" << "\n";
+  tracing_file << "%       Container string" << "\n";
+  tracing_file << "%       Value string" << "\n";
+  tracing_file << "%EndEventDef" << "\n";
 }
 
 void TRACE_header(bool basic, bool size)
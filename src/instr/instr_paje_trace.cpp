@@ -10,17 +10,20 @@
 #include "src/smpi/include/private.hpp"
 #include "typeinfo"
 #include <fstream>
+#include <map>
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(instr_paje_trace, instr, "tracing event system");
 
-extern std::ofstream tracing_file;
+extern std::ostream tracing_file;
 
-std::vector<simgrid::instr::PajeEvent*> buffer;
+/* The events that are not written yet, sorted by timestamp. Events of the same timestamp are kept in their creation
+ * order, since inserting into a multimap always places the new element after the equivalent ones. */
+static std::multimap<double, simgrid::instr::PajeEvent*> buffer;
 
 void dump_comment(std::string comment)
 {
   if (not comment.empty())
-    tracing_file << "# " << comment << std::endl;
+    tracing_file << "# " << comment << "\n";
 }
 
 void dump_comment_file(std::string filename)
@@ -47,33 +50,22 @@ void TRACE_paje_dump_buffer(bool force)
   if (not TRACE_is_enabled())
     return;
   XBT_DEBUG("%s: dump until %f. starts", __func__, TRACE_last_timestamp_to_dump);
-  if (force){
-    for (auto const& event : buffer) {
-      event->print();
-      delete event;
-    }
-    buffer.clear();
-  } else {
-    std::vector<simgrid::instr::PajeEvent*>::iterator i = buffer.begin();
-    for (auto const& event : buffer) {
-      double head_timestamp = event->timestamp_;
-      if (head_timestamp > TRACE_last_timestamp_to_dump)
-        break;
-      event->print();
-      delete event;
-      ++i;
-    }
-    buffer.erase(buffer.begin(), i);
+  auto end = force ? buffer.end() : buffer.upper_bound(TRACE_last_timestamp_to_dump);
+  for (auto it = buffer.begin(); it != end; ++it) {
+    it->second->print();
+    delete it->second;
   }
+  buffer.erase(buffer.begin(), end);
   XBT_DEBUG("%s: ends", __func__);
 }
 
-static void buffer_debug(std::vector<simgrid::instr::PajeEvent*>* buf)
+static void buffer_debug(std::multimap<double, simgrid::instr::PajeEvent*>* buf)
 {
   if (not XBT_LOG_ISENABLED(instr_paje_trace, xbt_log_priority_debug))
     return;
   XBT_DEBUG(">>>>>> Dump the state of the buffer. %zu events", buf->size());
-  for (auto const& event : *buf) {
+  for (auto const& elm : *buf) {
+    simgrid::instr::PajeEvent* event = elm.second;
     event->print();
     XBT_DEBUG("%p %s", event, event->stream_.str().c_str());
     event->stream_.str("");
@@ -88,20 +80,8 @@ void simgrid::instr::PajeEvent::insert_into_buffer()
   buffer_debug(&buffer);
 
   XBT_DEBUG("%s: insert event_type=%u, timestamp=%f, buffersize=%zu)", __func__, eventType_, timestamp_, buffer.size());
-  std::vector<simgrid::instr::PajeEvent*>::reverse_iterator i;
-  for (i = buffer.rbegin(); i != buffer.rend(); ++i) {
-    simgrid::instr::PajeEvent* e1 = *i;
-    XBT_DEBUG("compare to %p is of type %u; timestamp:%f", e1, e1->eventType_, e1->timestamp_);
-    if (e1->timestamp_ <= timestamp_)
-      break;
-  }
-  if (i == buffer.rend())
-    XBT_DEBUG("%s: inserted at beginning", __func__);
-  else if (i == buffer.rbegin())
-    XBT_DEBUG("%s: inserted at end", __func__);
-  else
-    XBT_DEBUG("%s: inserted at pos= %zd from its end", __func__, std::distance(buffer.rbegin(), i));
-  buffer.insert(i.base(), this);
+  // Events mostly come in order: hinting the end makes their insertion amortized constant time
+  buffer.emplace_hint(buffer.end(), timestamp_, this);
 
   buffer_debug(&buffer);
 }
@@ -8,7 +8,7 @@
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY (instr_paje_types, instr, "Paje tracing event system (types)");
 
-extern std::ofstream tracing_file;
+extern std::ostream tracing_file;
 // to check if variables were previously set to 0, otherwise paje won't simulate them
 static std::set<std::string> platform_variables;
 
@@ -163,7 +163,7 @@ void Type::log_definition(e_event_type event_type)
   if (is_colored())
     stream_ << " \"" << color_ << "\"";
   XBT_DEBUG("Dump %s", stream_.str().c_str());
-  tracing_file << stream_.str() << std::endl;
+  tracing_file << stream_.str() << "\n";
 }
 
 void Type::log_definition(simgrid::instr::Type* source, simgrid::instr::Type* dest)
@@ -174,7 +174,7 @@ void Type::log_definition(simgrid::instr::Type* source, simgrid::instr::Type* de
   stream_ << PAJE_DefineLinkType << " " << get_id() << " " << father_->get_id() << " " << source->get_id();
   stream_ << " " << dest->get_id() << " " << get_name();
   XBT_DEBUG("Dump %s", stream_.str().c_str());
-  tracing_file << stream_.str() << std::endl;
+  tracing_file << stream_.str() << "\n";
 }
 
 Type* Type::by_name(std::string name)
@@ -0,0 +1,124 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "src/instr/instr_trace_writer.hpp"
+#include "xbt/log.h"
+#include "xbt/sysdep.h"
+
+#include <cerrno>
+#include <cstring>
+
+XBT_LOG_NEW_DEFAULT_SUBCATEGORY(instr_trace_writer, instr, "Asynchronous writing of the trace file");
+
+namespace simgrid {
+namespace instr {
+
+constexpr unsigned TraceWriter::max_pending;
+
+TraceWriter::TraceWriter(std::FILE* file, std::size_t buffer_size)
+    : file_(file), buffer_size_(buffer_size), buffers_(max_pending + 1, std::vector<char>(buffer_size))
+{
+  for (unsigned i = 1; i < buffers_.size(); i++)
+    free_.push_back(buffers_[i].data());
+  setp(buffers_[0].data(), buffers_[0].data() + buffer_size_);
+
+  mutex_    = xbt_os_mutex_init();
+  has_full_ = xbt_os_cond_init();
+  has_free_ = xbt_os_cond_init();
+  thread_   = xbt_os_thread_create("trace writer", writer_main, this, nullptr);
+  XBT_DEBUG("Writing the trace with %u buffers of %zu bytes", max_pending + 1, buffer_size_);
+}
+
+TraceWriter::~TraceWriter()
+{
+  submit();
+  xbt_os_mutex_acquire(mutex_);
+  done_ = true;
+  xbt_os_cond_signal(has_full_);
+  xbt_os_mutex_release(mutex_);
+  xbt_os_thread_join(thread_, nullptr);
+
+  xbt_os_cond_destroy(has_free_);
+  xbt_os_cond_destroy(has_full_);
+  xbt_os_mutex_destroy(mutex_);
+  if (std::fclose(file_) != 0 && write_error_ == 0)
+    write_error_ = errno;
+  check_error();
+}
+
+/** @brief Reports the write errors of the writer thread, from the simulation thread (mutex_ held or thread joined) */
+void TraceWriter::check_error()
+{
+  if (write_error_ != 0)
+    xbt_die("Error while writing the trace file: %s", std::strerror(write_error_));
+}
+
+/** @brief Queue the buffer being filled for writing, and go on with a free one (waiting for it if needed) */
+void TraceWriter::submit()
+{
+  std::size_t size = pptr() - pbase();
+  if (size == 0)
+    return;
+
+  xbt_os_mutex_acquire(mutex_);
+  check_error();
+  full_.push_back({pbase(), size});
+  xbt_os_cond_signal(has_full_);
+  while (free_.empty()) {
+    XBT_DEBUG("All the buffers are waiting to be written, wait for the disk");
+    xbt_os_cond_wait(has_free_, mutex_);
+  }
+  char* buffer = free_.back();
+  free_.pop_back();
+  xbt_os_mutex_release(mutex_);
+
+  setp(buffer, buffer + buffer_size_);
+}
+
+TraceWriter::int_type TraceWriter::overflow(int_type ch)
+{
+  submit();
+  if (traits_type::eq_int_type(ch, traits_type::eof()))
+    return traits_type::not_eof(ch);
+  *pptr() = traits_type::to_char_type(ch);
+  pbump(1);
+  return ch;
+}
+
+int TraceWriter::sync()
+{
+  submit();
+  return 0;
+}
+
+void* TraceWriter::writer_main(void* arg)
+{
+  TraceWriter* writer = static_cast<TraceWriter*>(arg);
+
+  xbt_os_mutex_acquire(writer->mutex_);
+  while (true) {
+    while (writer->full_.empty() && not writer->done_)
+      xbt_os_cond_wait(writer->has_full_, writer->mutex_);
+    if (writer->full_.empty()) // done, and nothing left to write
+      break;
+    Chunk chunk = writer->full_.front();
+    writer->full_.pop_front();
+    xbt_os_mutex_release(writer->mutex_);
+
+    int error = 0;
+    if (writer->write_error_ == 0 && std::fwrite(chunk.data, 1, chunk.size, writer->file_) != chunk.size)
+      error = errno;
+
+    xbt_os_mutex_acquire(writer->mutex_);
+    if (error != 0 && writer->write_error_ == 0)
+      writer->write_error_ = error;
+    writer->free_.push_back(chunk.data);
+    xbt_os_cond_signal(writer->has_free_);
+  }
+  xbt_os_mutex_release(writer->mutex_);
+  return nullptr;
+}
+}
+}
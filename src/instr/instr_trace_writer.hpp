@@ -0,0 +1,65 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#ifndef INSTR_TRACE_WRITER_HPP
+#define INSTR_TRACE_WRITER_HPP
+
+#include "xbt/xbt_os_thread.h"
+
+#include <cstdio>
+#include <deque>
+#include <streambuf>
+#include <vector>
+
+namespace simgrid {
+namespace instr {
+
+/** @brief Stream buffer writing the trace file from a separate thread
+ *
+ * The formatted events are accumulated in large buffers. Full buffers are queued to a background thread that writes
+ * them to the file while the simulation goes on, and are then recycled. At most max_pending buffers can be waiting
+ * for the disk: when the simulation produces events faster than they can be written, it waits for the writer thread.
+ */
+class TraceWriter : public std::streambuf {
+public:
+  static constexpr unsigned max_pending = 4;
+
+  TraceWriter(std::FILE* file, std::size_t buffer_size);
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+  /** Writes all the pending data, stops the writer thread and closes the file */
+  ~TraceWriter();
+
+protected:
+  int_type overflow(int_type ch) override;
+  int sync() override;
+
+private:
+  struct Chunk {
+    char* data;
+    std::size_t size;
+  };
+
+  static void* writer_main(void* arg);
+  void submit();
+  void check_error();
+
+  std::FILE* file_;
+  std::size_t buffer_size_;
+  std::vector<std::vector<char>> buffers_;
+  std::deque<Chunk> full_;  /* buffers waiting to be written, in order */
+  std::vector<char*> free_; /* buffers that can be filled */
+  bool done_      = false;
+  int write_error_ = 0; /* errno of the first failed write, reported by maestro (the writer thread then stops writing) */
+
+  xbt_os_thread_t thread_;
+  xbt_os_mutex_t mutex_;
+  xbt_os_cond_t has_full_; /* signaled when a buffer is queued for writing, or on termination */
+  xbt_os_cond_t has_free_; /* signaled when a buffer is recycled */
+};
+}
+}
+
+#endif
@@ -10,6 +10,24 @@ XBT_LOG_NEW_DEFAULT_SUBCATEGORY(simix_mailbox, simix, "Mailbox implementation");
 
 static std::map<std::string, smx_mailbox_t>* mailboxes = new std::map<std::string, smx_mailbox_t>;
 
+/* The descriptor functions associated to the match functions (there are only a few of them) */
+static std::vector<std::pair<simix_match_func_t, simgrid::kernel::activity::match_descriptor_func_t>> match_descriptors;
+
+static bool get_match_descriptor(simix_match_func_t match_fun, void* data,
+                                 simgrid::kernel::activity::MatchDescriptor* descriptor)
+{
+  if (match_fun != nullptr)
+    for (auto const& elm : match_descriptors)
+      if (elm.first == match_fun)
+        return elm.second(data, descriptor);
+  return false;
+}
+
+static void* get_user_data(simgrid::kernel::activity::CommImpl* comm)
+{
+  return comm->type == SIMIX_COMM_SEND ? comm->src_data : comm->dst_data;
+}
+
 void SIMIX_mailbox_exit()
 {
   for (auto const& elm : *mailboxes)
@@ -24,6 +42,133 @@ void SIMIX_mailbox_exit()
 namespace simgrid {
 namespace kernel {
 namespace activity {
+
+/** @brief Queues a communication, whose type, match function and user data must already be set */
+void CommQueue::push_back(CommImplPtr comm)
+{
+  xbt_assert(comm->type == SIMIX_COMM_SEND || comm->type == SIMIX_COMM_RECEIVE,
+             "Only the send and receive communications can be queued");
+  MatchDescriptor descriptor;
+  bool indexed = get_match_descriptor(comm->match_fun, get_user_data(comm.get()), &descriptor);
+  Key key      = indexed ? Key{comm->type, descriptor.source, descriptor.tag} : Key{comm->type, 0, 0};
+
+  if (indexed && not indexing_) {
+    /* Start maintaining the index: the communications queued so far cannot be indexed */
+    for (auto it = comms_.begin(); it != comms_.end(); ++it)
+      add_to_index(it, unindexed_[it->key.type]);
+    indexing_ = true;
+  }
+
+  comms_.push_back(Entry{std::move(comm), next_rank_++, indexed, key, nullptr, IndexList::iterator()});
+  iterator it = std::prev(comms_.end());
+  positions_.insert({it->comm.get(), it});
+  if (indexed)
+    add_to_index(it, index_[key]);
+  else if (indexing_)
+    add_to_index(it, unindexed_[key.type]);
+}
+
+void CommQueue::add_to_index(iterator it, IndexList& list)
+{
+  it->index_list = &list; // The lists of index_ do not move when it gets rehashed
+  it->index_pos  = list.insert(list.end(), it);
+}
+
+void CommQueue::erase(iterator it)
+{
+  if (it->index_list != nullptr) {
+    it->index_list->erase(it->index_pos);
+    if (it->indexed && it->index_list->empty())
+      index_.erase(it->key);
+  }
+  positions_.erase(it->comm.get());
+  comms_.erase(it);
+}
+
+/** @brief Removes a communication from the queue, returning false if it was not there */
+bool CommQueue::remove(CommImpl* comm)
+{
+  auto position = positions_.find(comm);
+  if (position == positions_.end())
+    return false;
+  erase(position->second);
+  return true;
+}
+
+static bool comm_matches(CommImpl* comm, e_smx_comm_type_t type, simix_match_func_t match_fun, void* this_user_data,
+                         CommImpl* my_synchro)
+{
+  void* other_user_data = get_user_data(comm);
+  return comm->type == type && (match_fun == nullptr || match_fun(this_user_data, other_user_data, comm)) &&
+         (not comm->match_fun || comm->match_fun(other_user_data, this_user_data, my_synchro));
+}
+
+/** @brief Looks for the first queued communication matching our needs
+ *
+ * @param type The type of communication we are looking for (comm_send, comm_recv)
+ * @param match_fun the function to apply
+ * @param this_user_data additional parameter to the match_fun
+ * @param my_synchro what to compare against
+ * @param remove_matching whether or not to clean the found object from the queue
+ * @return The communication activity if found, nullptr otherwise
+ */
+CommImplPtr CommQueue::find_matching(e_smx_comm_type_t type, simix_match_func_t match_fun, void* this_user_data,
+                                     CommImplPtr my_synchro, bool remove_matching)
+{
+  iterator found = comms_.end();
+  MatchDescriptor descriptor;
+
+  if (indexing_ && get_match_descriptor(match_fun, this_user_data, &descriptor)) {
+    /* Merge the communications indexed with our key and the ones that could not be indexed, in FIFO order */
+    static const IndexList no_comm;
+    auto bucket                = index_.find(Key{type, descriptor.source, descriptor.tag});
+    const IndexList& indexed   = bucket == index_.end() ? no_comm : bucket->second;
+    const IndexList& unindexed = unindexed_[type];
+    auto i                     = indexed.begin();
+    auto j                     = unindexed.begin();
+    while (i != indexed.end() || j != unindexed.end()) {
+      iterator candidate = (j == unindexed.end() || (i != indexed.end() && (*i)->rank < (*j)->rank)) ? *i++ : *j++;
+      if (comm_matches(candidate->comm.get(), type, match_fun, this_user_data, my_synchro.get())) {
+        found = candidate;
+        break;
+      }
+      XBT_DEBUG("Sorry, communication synchro %p does not match our needs", candidate->comm.get());
+    }
+  } else {
+    for (auto it = comms_.begin(); it != comms_.end(); ++it) {
+      if (comm_matches(it->comm.get(), type, match_fun, this_user_data, my_synchro.get())) {
+        found = it;
+        break;
+      }
+      XBT_DEBUG("Sorry, communication synchro %p does not match our needs:"
+                " its type is %d but we are looking for a comm of type %d (or maybe the filtering didn't match)",
+                it->comm.get(), (int)it->comm->type, (int)type);
+    }
+  }
+
+  if (found == comms_.end())
+    return nullptr;
+  CommImplPtr comm = found->comm;
+  if (remove_matching)
+    erase(found);
+  return comm;
+}
+
+/** @brief Declares how to describe the user data of the communications using this match function
+ *
+ * The descriptors let the mailboxes index the communications instead of trying the match functions on every queued
+ * communication. Two communications with complete descriptors must only match if their descriptors are equal.
+ */
+void MailboxImpl::set_match_descriptor(simix_match_func_t match_fun, match_descriptor_func_t descriptor_fun)
+{
+  for (auto& elm : match_descriptors)
+    if (elm.first == match_fun) {
+      elm.second = descriptor_fun;
+      return;
+    }
+  match_descriptors.push_back({match_fun, descriptor_fun});
+}
+
 /** @brief Returns the mailbox of that name, or nullptr */
 MailboxImpl* MailboxImpl::byNameOrNull(const char* name)
 {
@@ -77,12 +222,8 @@ void MailboxImpl::remove(smx_activity_t activity)
   xbt_assert(comm->mbox == this, "Comm %p is in mailbox %s, not mailbox %s", comm.get(),
              (comm->mbox ? comm->mbox->get_cname() : "(null)"), this->get_cname());
   comm->mbox = nullptr;
-  for (auto it = this->comm_queue.begin(); it != this->comm_queue.end(); it++)
-    if (*it == comm) {
-      this->comm_queue.erase(it);
-      return;
-    }
-  xbt_die("Comm %p not found in mailbox %s", comm.get(), this->get_cname());
+  if (not this->comm_queue.remove(comm.get()))
+    xbt_die("Comm %p not found in mailbox %s", comm.get(), this->get_cname());
 }
 }
 }
@@ -6,25 +6,96 @@
 #ifndef SIMIX_MAILBOXIMPL_H
 #define SIMIX_MAILBOXIMPL_H
 
-#include <boost/circular_buffer.hpp>
 #include <xbt/string.hpp>
 
+#include <list>
+#include <unordered_map>
+
 #include "simgrid/s4u/Mailbox.hpp"
 #include "src/kernel/activity/CommImpl.hpp"
 #include "src/simix/ActorImpl.hpp"
 
-#define MAX_MAILBOX_SIZE 10000000
 namespace simgrid {
 namespace kernel {
 namespace activity {
 
+/** @brief Structured description of the messages accepted by a communication (see MailboxImpl::set_match_descriptor) */
+struct MatchDescriptor {
+  int source;
+  int tag;
+};
+
+/** @brief Fills the descriptor of the user data of a communication.
+ *
+ * Returns false if the communication accepts several descriptors (any source, any tag), in which case it can only be
+ * matched by calling the match functions.
+ */
+typedef bool (*match_descriptor_func_t)(void* data, MatchDescriptor* descriptor);
+
+/** @brief FIFO of the communications waiting in a mailbox
+ *
+ * A communication matches the first queued communication of the requested type that is accepted by the match
+ * functions of both sides. When the match functions come with a descriptor function, the queued communications with a
+ * complete descriptor are also indexed by (type, source, tag). The communications with a complete descriptor then only
+ * try the queued communications with the same key and the ones that cannot be indexed (wildcards or generic match
+ * functions), in FIFO order, instead of walking the whole queue.
+ */
+class CommQueue {
+public:
+  bool empty() const { return comms_.empty(); }
+  std::size_t size() const { return comms_.size(); }
+  CommImplPtr front() const { return comms_.front().comm; }
+  void push_back(CommImplPtr comm);
+  bool remove(CommImpl* comm);
+  CommImplPtr find_matching(e_smx_comm_type_t type, simix_match_func_t match_fun, void* data, CommImplPtr my_synchro,
+                            bool remove_matching);
+
+private:
+  struct Key {
+    int type;
+    int source;
+    int tag;
+    bool operator==(const Key& other) const
+    {
+      return type == other.type && source == other.source && tag == other.tag;
+    }
+  };
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const
+    {
+      std::size_t h = std::hash<int>()(key.source);
+      h ^= std::hash<int>()(key.tag) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      h ^= std::hash<int>()(key.type) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      return h;
+    }
+  };
+  struct Entry;
+  typedef std::list<Entry>::iterator iterator;
+  typedef std::list<iterator> IndexList;
+  struct Entry {
+    CommImplPtr comm;
+    unsigned long rank; /* position in the FIFO, to merge the index lists */
+    bool indexed;
+    Key key;
+    IndexList* index_list; /* the index list holding this communication (if any), and its position in there */
+    IndexList::iterator index_pos;
+  };
+
+  void add_to_index(iterator it, IndexList& list);
+  void erase(iterator it);
+
+  std::list<Entry> comms_;
+  unsigned long next_rank_ = 0;
+  bool indexing_           = false; /* whether a communication with a complete descriptor was ever queued */
+  std::unordered_map<Key, IndexList, KeyHash> index_;
+  IndexList unindexed_[2]; /* per type, the communications without descriptor (once indexing_ is set) */
+  std::unordered_map<CommImpl*, iterator> positions_; /* where each communication is queued, to remove it quickly */
+};
+
 /** @brief Implementation of the simgrid::s4u::Mailbox */
 
 class MailboxImpl {
-  explicit MailboxImpl(const char* name)
-      : piface_(this), name_(name), comm_queue(MAX_MAILBOX_SIZE), done_comm_queue(MAX_MAILBOX_SIZE)
-  {
-  }
+  explicit MailboxImpl(const char* name) : piface_(this), name_(name) {}
 
 public:
   const simgrid::xbt::string& get_name() const { return name_; }
@@ -34,12 +105,13 @@ public:
   void setReceiver(s4u::ActorPtr actor);
   void push(activity::CommImplPtr comm);
   void remove(smx_activity_t activity);
+  static void set_match_descriptor(simix_match_func_t match_fun, match_descriptor_func_t descriptor_fun);
   simgrid::s4u::Mailbox piface_; // Our interface
   simgrid::xbt::string name_;
 
   simgrid::kernel::actor::ActorImplPtr permanent_receiver; // actor to which the mailbox is attached
-  boost::circular_buffer_space_optimized<smx_activity_t> comm_queue;
-  boost::circular_buffer_space_optimized<smx_activity_t> done_comm_queue; // messages already received in the permanent receive mode
+  CommQueue comm_queue;
+  CommQueue done_comm_queue; // messages already received in the permanent receive mode
 };
 }
 }
@@ -74,6 +74,14 @@ public:
   virtual ~Context();
   virtual void stop();
   virtual void suspend() = 0;
+
+  /** @brief Makes sure that the local variables of this (suspended) context can be accessed by maestro
+   *
+   * This is only needed by the factories where several contexts share the same stack.
+   */
+  virtual void load_stack() {}
+  /** @brief Whether loading the stack of this context may overwrite the given address */
+  virtual bool stack_overlaps(const void* /*addr*/) const { return false; }
 };
 
 class XBT_PUBLIC AttachContext : public Context {
@@ -102,6 +110,7 @@ XBT_PRIVATE ContextFactory* thread_factory();
 XBT_PRIVATE ContextFactory* sysv_factory();
 XBT_PRIVATE ContextFactory* raw_factory();
 XBT_PRIVATE ContextFactory* boost_factory();
+XBT_PRIVATE ContextFactory* shared_factory();
 
 }}}
 
@@ -0,0 +1,172 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "ContextShared.hpp"
+#include "mc/mc.h"
+#include "src/simix/smx_private.hpp"
+#include "xbt/config.hpp"
+
+#include <cstring>
+
+XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(simix_context);
+
+static simgrid::config::Flag<int> shared_stack_count("contexts/shared-stacks",
+                                                     "Number of execution stacks shared by the actors with the shared "
+                                                     "context factory",
+                                                     4, [](int const& val) {
+                                                       if (val < 1)
+                                                         xbt_die("contexts/shared-stacks must be positive");
+                                                     });
+
+// Context switching routines, provided by the raw contexts
+
+typedef void (*rawctx_entry_point_t)(void*);
+typedef void* raw_stack_t;
+extern "C" raw_stack_t raw_makecontext(void* malloced_stack, int stack_size, rawctx_entry_point_t entry_point,
+                                       void* arg);
+extern "C" void raw_swapcontext(raw_stack_t* old, raw_stack_t new_context);
+
+#if HAVE_RAW_CONTEXTS
+static_assert(PTH_STACKGROWTH == -1, "The shared contexts assume that the stack grows downward");
+#endif
+
+namespace simgrid {
+namespace kernel {
+namespace context {
+
+static SharedContext* maestro_context = nullptr;
+static unsigned long stack_copies     = 0;
+static unsigned long long copied_size = 0;
+
+// SharedContextFactory
+
+SharedContextFactory::SharedContextFactory() : ContextFactory("SharedContextFactory"), stacks_(shared_stack_count)
+{
+  if (SIMIX_context_is_parallel())
+    xbt_die("The shared contexts cannot run the actors in parallel. Please use another context factory.");
+  xbt_assert(not MC_is_active(), "The shared contexts cannot be used with the model checker.");
+  maestro_context = nullptr;
+  stack_copies    = 0;
+  copied_size     = 0;
+}
+
+SharedContextFactory::~SharedContextFactory()
+{
+  for (SharedStack const& stack : stacks_)
+    SIMIX_context_stack_delete(stack.stack);
+  if (stack_copies > 0)
+    XBT_VERB("Shared stacks: the frames of the actors were saved %lu times, %llu KiB copied in total", stack_copies,
+             copied_size / 1024);
+}
+
+Context* SharedContextFactory::create_context(std::function<void()> code, void_pfn_smxprocess_t cleanup_func,
+                                              smx_actor_t process)
+{
+  SharedStack* stack = nullptr;
+  if (code) {
+    /* The actors are distributed over the stacks in turn, the stacks being allocated on first use */
+    stack       = &stacks_[next_stack_];
+    next_stack_ = (next_stack_ + 1) % stacks_.size();
+    if (stack->stack == nullptr) {
+      stack->stack = static_cast<char*>(SIMIX_context_stack_new());
+      stack->top   = stack->stack + smx_context_usable_stack_size;
+    }
+  }
+  return this->new_context<SharedContext>(std::move(code), cleanup_func, process, stack);
+}
+
+/** @brief Runs the actors one after the other, going back to maestro in between so that maestro can move the frames
+ * of the actors without running on the shared stacks. */
+void SharedContextFactory::run_all()
+{
+  for (smx_actor_t const& process : simix_global->process_to_run)
+    static_cast<SharedContext*>(process->context)->resume();
+}
+
+// SharedContext
+
+SharedContext::SharedContext(std::function<void()> code, void_pfn_smxprocess_t cleanup_func, smx_actor_t process,
+                             SharedStack* stack)
+    : Context(std::move(code), cleanup_func, process), shared_stack_(stack)
+{
+  if (not has_code() && process != nullptr && maestro_context == nullptr)
+    maestro_context = this;
+}
+
+SharedContext::~SharedContext()
+{
+  if (shared_stack_ != nullptr && shared_stack_->owner == this)
+    shared_stack_->owner = nullptr;
+  if (this == maestro_context)
+    maestro_context = nullptr;
+}
+
+void SharedContext::wrapper(void* arg)
+{
+  SharedContext* context = static_cast<SharedContext*>(arg);
+  try {
+    (*context)();
+    context->Context::stop();
+  } catch (StopRequest const&) {
+    XBT_DEBUG("Caught a StopRequest");
+  }
+  context->suspend();
+}
+
+/** @brief Copies the used part of the shared stack in the buffer of this context */
+void SharedContext::save_stack()
+{
+  char* sp = static_cast<char*>(stack_top_);
+  saved_stack_.assign(sp, shared_stack_->top);
+  stack_copies++;
+  copied_size += saved_stack_.size();
+}
+
+void SharedContext::load_stack()
+{
+  if (shared_stack_ == nullptr || shared_stack_->owner == this)
+    return;
+  if (shared_stack_->owner != nullptr)
+    shared_stack_->owner->save_stack();
+  if (started_) {
+    memcpy(shared_stack_->top - saved_stack_.size(), saved_stack_.data(), saved_stack_.size());
+    copied_size += saved_stack_.size();
+  } else {
+    stack_top_ = raw_makecontext(shared_stack_->stack, smx_context_usable_stack_size, SharedContext::wrapper, this);
+    started_   = true;
+  }
+  shared_stack_->owner = this;
+}
+
+bool SharedContext::stack_overlaps(const void* addr) const
+{
+  return shared_stack_ != nullptr && addr >= shared_stack_->stack && addr < shared_stack_->top;
+}
+
+void SharedContext::resume()
+{
+  load_stack();
+  SIMIX_context_set_current(this);
+  raw_swapcontext(&maestro_context->stack_top_, this->stack_top_);
+}
+
+void SharedContext::suspend()
+{
+  SIMIX_context_set_current(maestro_context);
+  raw_swapcontext(&this->stack_top_, maestro_context->stack_top_);
+}
+
+void SharedContext::stop()
+{
+  Context::stop();
+  throw StopRequest();
+}
+
+ContextFactory* shared_factory()
+{
+  XBT_VERB("Using shared contexts. Because the memory is not infinite.");
+  return new SharedContextFactory();
+}
+}}}
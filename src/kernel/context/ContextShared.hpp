@@ -0,0 +1,72 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#ifndef SIMGRID_SIMIX_SHARED_CONTEXT_HPP
+#define SIMGRID_SIMIX_SHARED_CONTEXT_HPP
+
+#include <functional>
+#include <vector>
+
+#include "src/kernel/context/Context.hpp"
+
+namespace simgrid {
+namespace kernel {
+namespace context {
+
+class SharedContext;
+
+/** @brief An execution stack, on which several actors run in turn */
+struct SharedStack {
+  char* stack          = nullptr;
+  char* top            = nullptr;
+  SharedContext* owner = nullptr; /* context whose frames are currently on the stack */
+};
+
+/** @brief Stack-copying contexts, built on the raw context switching routines.
+ *
+ * All the actors run on a few shared execution stacks. When an actor needs to run on a stack holding the frames of
+ * another actor, the used part of the other actor's stack (that is, from its saved stack pointer to the top of the
+ * stack) is saved in its own buffer, and the frames of the actor are copied back in place. Each actor only keeps the
+ * part of its stack that it actually uses, at the price of a memcpy when the actors sharing a stack run in turn.
+ *
+ * Since the frames are always restored at the same address, the pointers to the local variables remain valid. But
+ * the local variables of an actor can only be accessed while its frames are in place: maestro has to call
+ * load_stack() before that, and the actors must not access the stack of each other.
+ */
+class SharedContext : public Context {
+public:
+  SharedContext(std::function<void()> code, void_pfn_smxprocess_t cleanup_func, smx_actor_t process,
+                SharedStack* stack);
+  ~SharedContext() override;
+  void stop() override;
+  void suspend() override;
+  void resume();
+  void load_stack() override;
+  bool stack_overlaps(const void* addr) const override;
+
+private:
+  static void wrapper(void* arg);
+  void save_stack();
+
+  SharedStack* shared_stack_ = nullptr;
+  void* stack_top_           = nullptr; /* saved stack pointer */
+  bool started_              = false;
+  std::vector<char> saved_stack_; /* used part of the stack, while other contexts run on the shared stack */
+};
+
+class SharedContextFactory : public ContextFactory {
+public:
+  SharedContextFactory();
+  ~SharedContextFactory() override;
+  Context* create_context(std::function<void()> code, void_pfn_smxprocess_t cleanup, smx_actor_t process) override;
+  void run_all() override;
+
+private:
+  std::vector<SharedStack> stacks_;
+  unsigned next_stack_ = 0;
+};
+}}} // namespace
+
+#endif
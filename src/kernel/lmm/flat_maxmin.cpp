@@ -0,0 +1,253 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "src/kernel/lmm/maxmin.hpp"
+#include "src/surf/surf_interface.hpp"
+
+XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(surf_maxmin);
+
+namespace simgrid {
+namespace kernel {
+namespace lmm {
+
+System* make_new_flat_maxmin_system(bool selective_update)
+{
+  return new FlatMaxMin(selective_update);
+}
+
+void FlatMaxMin::flat_solve()
+{
+  if (not modified_)
+    return;
+
+  XBT_IN("(sys=%p)", this);
+  if (selective_update_active)
+    build_arrays(modified_constraint_set);
+  else
+    build_arrays(active_constraint_set);
+  saturate();
+
+  /* Write the results back into the linked representation */
+  for (unsigned v = 0; v < var_.size(); v++)
+    var_[v]->value = value_[v];
+  for (unsigned c = 0; c < cnst_.size(); c++) {
+    cnst_[c]->remaining = remaining_[c];
+    cnst_[c]->usage     = usage_[c];
+  }
+
+  modified_ = false;
+  if (selective_update_active)
+    remove_all_modified_set();
+
+  if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
+    print();
+  }
+
+  check_concurrency();
+  XBT_OUT();
+}
+
+/** @brief Copy the part of the system that needs to be solved into the contiguous arrays.
+ *
+ * Only the enabled elements with a positive consumption weight are kept in the constraint-to-variable matrix, since
+ * they are the only ones that the saturation ever looks at. The arrays keep their capacity from one resolution to the
+ * next, so that solving a system of stable size does not allocate anything.
+ */
+template <class CnstList> void FlatMaxMin::build_arrays(CnstList& cnst_list)
+{
+  cnst_.clear();
+  var_.clear();
+  for (Constraint& cnst : cnst_list) {
+    cnst.rank = cnst_.size();
+    cnst_.push_back(&cnst);
+    for (Element const& elem : cnst.enabled_element_set)
+      elem.variable->rank = -1;
+  }
+
+  /* Constraint side: bounds and the CSR matrix of the elements */
+  unsigned nb_cnst = cnst_.size();
+  bound_.resize(nb_cnst);
+  remaining_.resize(nb_cnst);
+  usage_.resize(nb_cnst);
+  fatpipe_.resize(nb_cnst);
+  cnst_begin_.resize(nb_cnst + 1);
+  elem_var_.clear();
+  elem_share_.clear();
+  for (unsigned c = 0; c < nb_cnst; c++) {
+    Constraint* cnst = cnst_[c];
+    bound_[c]        = cnst->bound;
+    fatpipe_[c]      = (cnst->sharing_policy == s4u::Link::SharingPolicy::FATPIPE);
+    cnst_begin_[c]   = elem_var_.size();
+    for (Element const& elem : cnst->enabled_element_set) {
+      Variable* var = elem.variable;
+      xbt_assert(var->sharing_weight > 0.0);
+      var->value = 0.0;
+      if (var->rank < 0) {
+        var->rank = var_.size();
+        var_.push_back(var);
+      }
+      if (elem.consumption_weight > 0) {
+        elem_var_.push_back(var->rank);
+        elem_share_.push_back(elem.consumption_weight / var->sharing_weight);
+      }
+    }
+  }
+  cnst_begin_[nb_cnst] = elem_var_.size();
+
+  /* Variable side: weights, bounds and the CSR matrix of all the constraints using each variable */
+  unsigned nb_var = var_.size();
+  weight_.resize(nb_var);
+  var_bound_.resize(nb_var);
+  value_.assign(nb_var, 0.0);
+  saturated_.assign(nb_var, 0);
+  var_begin_.resize(nb_var + 1);
+  var_cnst_.clear();
+  var_cnst_weight_.clear();
+  for (unsigned v = 0; v < nb_var; v++) {
+    Variable* var  = var_[v];
+    weight_[v]     = var->sharing_weight;
+    var_bound_[v]  = var->bound;
+    var_begin_[v]  = var_cnst_.size();
+    for (Element const& elem : var->cnsts) {
+      var_cnst_.push_back(elem.constraint->rank);
+      var_cnst_weight_.push_back(elem.consumption_weight);
+    }
+  }
+  var_begin_[nb_var] = var_cnst_.size();
+}
+
+/** @brief Recompute the usage of a FATPIPE constraint from its variables that are not fixed yet */
+double FlatMaxMin::fatpipe_usage(unsigned c) const
+{
+  double usage = 0.0;
+  for (unsigned e = cnst_begin_[c]; e < cnst_begin_[c + 1]; e++)
+    if (value_[elem_var_[e]] <= 0.0)
+      usage = std::max(usage, elem_share_[e]);
+  return usage;
+}
+
+/** @brief Stop considering a constraint for saturation (swap it with the last active one) */
+void FlatMaxMin::deactivate(unsigned cnst)
+{
+  unsigned slot = slot_[cnst];
+  unsigned last = active_.back();
+  active_[slot]       = last;
+  active_ratio_[slot] = active_ratio_.back();
+  slot_[last]         = slot;
+  slot_[cnst]         = -1;
+  active_.pop_back();
+  active_ratio_.pop_back();
+}
+
+/** @brief The max-min saturation loop, same algorithm as System::lmm_solve() on the contiguous arrays.
+ *
+ * The remaining/usage ratios of the constraints that are still to be saturated are kept packed in active_ratio_, so
+ * that finding the next bottleneck is a branch-free reduction over a dense vector, which the compiler vectorizes.
+ */
+void FlatMaxMin::saturate()
+{
+  unsigned nb_cnst = cnst_.size();
+  active_.clear();
+  active_ratio_.clear();
+  slot_.assign(nb_cnst, -1);
+
+  for (unsigned c = 0; c < nb_cnst; c++) {
+    remaining_[c] = bound_[c];
+    usage_[c]     = 0.0;
+    if (not double_positive(remaining_[c], bound_[c] * sg_maxmin_precision))
+      continue;
+    double usage = 0.0;
+    if (fatpipe_[c]) {
+      for (unsigned e = cnst_begin_[c]; e < cnst_begin_[c + 1]; e++)
+        usage = std::max(usage, elem_share_[e]);
+    } else {
+      for (unsigned e = cnst_begin_[c]; e < cnst_begin_[c + 1]; e++)
+        usage += elem_share_[e];
+    }
+    usage_[c] = usage;
+    if (modified_set_) {
+      for (unsigned e = cnst_begin_[c]; e < cnst_begin_[c + 1]; e++) {
+        resource::Action* action = var_[elem_var_[e]]->id;
+        if (not action->is_within_modified_set())
+          modified_set_->push_back(*action);
+      }
+    }
+    XBT_DEBUG("Constraint '%d' usage: %f remaining: %f", cnst_[c]->id_int, usage_[c], remaining_[c]);
+    if (usage > 0) {
+      slot_[c] = active_.size();
+      active_.push_back(c);
+      active_ratio_.push_back(remaining_[c] / usage);
+    }
+  }
+
+  while (not active_.empty()) {
+    /* Find out the bottleneck value, and the variables of the constraints that reach it */
+    const double* ratio = active_ratio_.data();
+    unsigned nb_active  = active_.size();
+    double min_usage    = ratio[0];
+    for (unsigned i = 1; i < nb_active; i++)
+      min_usage = ratio[i] < min_usage ? ratio[i] : min_usage;
+    XBT_DEBUG("min_usage=%f", min_usage);
+
+    saturated_vars_.clear();
+    for (unsigned i = 0; i < nb_active; i++) {
+      if (not double_equals(ratio[i], min_usage, sg_maxmin_precision))
+        continue;
+      unsigned c = active_[i];
+      for (unsigned e = cnst_begin_[c]; e < cnst_begin_[c + 1]; e++) {
+        unsigned v = elem_var_[e];
+        if (value_[v] <= 0.0 && not saturated_[v]) {
+          saturated_[v] = 1;
+          saturated_vars_.push_back(v);
+        }
+      }
+    }
+    xbt_assert(not saturated_vars_.empty(),
+               "Cannot saturate more a constraint that has no active element! You may want to change the maxmin "
+               "precision (--cfg=maxmin/precision:<new_value>) because of possible rounding effects.");
+
+    /* Check whether some of these variables reach their upper bound first */
+    double min_bound = -1;
+    for (unsigned v : saturated_vars_) {
+      double bound = var_bound_[v] * weight_[v];
+      if (var_bound_[v] > 0 && bound < min_usage && (min_bound < 0 || bound < min_bound))
+        min_bound = bound;
+    }
+
+    for (unsigned v : saturated_vars_) {
+      saturated_[v] = 0;
+      if (min_bound < 0) {
+        value_[v] = min_usage / weight_[v];
+      } else if (double_equals(min_bound, var_bound_[v] * weight_[v], sg_maxmin_precision)) {
+        value_[v] = var_bound_[v];
+      } else {
+        // Variables which bound is different are not considered for this cycle, but they will be afterwards.
+        continue;
+      }
+      XBT_DEBUG("Setting var (%d) value to %f", var_[v]->id_int, value_[v]);
+
+      /* Update the usage of the constraints where this variable is involved */
+      for (unsigned k = var_begin_[v]; k < var_begin_[v + 1]; k++) {
+        unsigned c = var_cnst_[k];
+        if (fatpipe_[c]) {
+          usage_[c] = fatpipe_usage(c);
+        } else {
+          double_update(&remaining_[c], var_cnst_weight_[k] * value_[v], bound_[c] * sg_maxmin_precision);
+          double_update(&usage_[c], var_cnst_weight_[k] / weight_[v], sg_maxmin_precision);
+        }
+        if (slot_[c] < 0)
+          continue;
+        if (not double_positive(usage_[c], sg_maxmin_precision) ||
+            not double_positive(remaining_[c], bound_[c] * sg_maxmin_precision))
+          deactivate(c);
+        else
+          active_ratio_[slot_[c]] = remaining_[c] / usage_[c];
+      }
+    }
+  }
+}
+}
+}
+}
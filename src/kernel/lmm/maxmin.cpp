@@ -4,14 +4,20 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include "src/kernel/lmm/maxmin.hpp"
+#include "src/include/xbt/parmap.hpp"
 #include "src/surf/surf_interface.hpp"
 #include "xbt/backtrace.hpp"
 
+#include <boost/range/adaptor/indirected.hpp>
+
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_maxmin, surf, "Logging specific to SURF (maxmin)");
 
 double sg_maxmin_precision = 0.00001; /* Change this with --cfg=maxmin/precision:VALUE */
 double sg_surf_precision   = 0.00001; /* Change this with --cfg=surf/precision:VALUE */
 int sg_concurrency_limit   = -1;      /* Change this with --cfg=maxmin/concurrency-limit:VALUE */
+int sg_maxmin_nthreads     = 1;       /* Change this with --cfg=maxmin/nthreads:VALUE */
+bool sg_maxmin_split_components = false; /* Change this with --cfg=maxmin/split-components:yes */
+std::string sg_maxmin_solver("default"); /* Change this with --cfg=maxmin/solver:VALUE */
 
 namespace simgrid {
 namespace kernel {
@@ -24,6 +30,8 @@ int Constraint::Global_debug_id = 1;
 
 System* make_new_maxmin_system(bool selective_update)
 {
+  if (sg_maxmin_solver == "flat")
+    return new FlatMaxMin(selective_update);
   return new System(selective_update);
 }
 
@@ -161,6 +169,7 @@ System::~System()
 
   xbt_mallocator_free(variable_mallocator_);
   delete modified_set_;
+  delete parmap_;
 }
 
 void System::cnst_free(Constraint* cnst)
@@ -400,8 +409,9 @@ static inline void saturated_constraints_update(double usage, int cnst_light_num
   }
 }
 
+template <class VarList>
 static inline void saturated_variable_set_update(ConstraintLight* cnst_light_tab,
-                                                 const dyn_light_t& saturated_constraints, System* sys)
+                                                 const dyn_light_t& saturated_constraints, VarList& saturated_vars)
 {
   /* Add active variables (i.e. variables that need to be set) from the set of constraints to saturate
    * (cnst_light_tab)*/
@@ -411,7 +421,7 @@ static inline void saturated_variable_set_update(ConstraintLight* cnst_light_tab
       // Visiting active_element_set, so, by construction, should never get a zero weight, correct?
       xbt_assert(elem.variable->sharing_weight > 0);
       if (elem.consumption_weight > 0 && not elem.variable->saturated_variable_set_hook.is_linked())
-        sys->saturated_variable_set.push_back(*elem.variable);
+        saturated_vars.push_back(*elem.variable);
     }
   }
 }
@@ -488,11 +498,120 @@ void System::lmm_solve()
       lmm_solve(modified_constraint_set);
     else
       lmm_solve(active_constraint_set);
+
+    modified_ = false;
+    if (selective_update_active)
+      remove_all_modified_set();
+
+    if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
+      print();
+    }
+
+    check_concurrency();
     XBT_OUT();
   }
 }
 
 template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
+{
+  if (sg_maxmin_split_components) {
+    find_components(cnst_list);
+    if (components_.size() > 1) {
+      XBT_DEBUG("Solving %zu independent components on %d threads", components_.size(), sg_maxmin_nthreads);
+      components_todo_.clear();
+      for (std::vector<Constraint*>& component : components_)
+        components_todo_.push_back(&component);
+      if (parmap_ == nullptr)
+        parmap_ = new xbt::Parmap<std::vector<Constraint*>*>(sg_maxmin_nthreads, XBT_PARMAP_DEFAULT);
+      parmap_->apply(&System::solve_component, components_todo_);
+
+      /* Fill the modified set afterward, in the very same order than the sequential resolution would have used */
+      if (modified_set_) {
+        for (Constraint const& cnst : cnst_list) {
+          if (not double_positive(cnst.bound, cnst.bound * sg_maxmin_precision))
+            continue;
+          for (Element const& elem : cnst.enabled_element_set) {
+            resource::Action* action = static_cast<resource::Action*>(elem.variable->id);
+            if (elem.consumption_weight > 0 && not action->is_within_modified_set())
+              modified_set_->push_back(*action);
+          }
+        }
+      }
+      return;
+    }
+  }
+  lmm_solve(cnst_list, saturated_variable_set, modified_set_);
+}
+
+template <class CnstList> void System::find_components(CnstList& cnst_list)
+{
+  /* Union-find over the constraints, linked through their enabled variables: each constraint is linked to the first
+   * constraint of each of its variables. That first constraint may not be in the list, so every constraint reached
+   * through a variable gets a rank too (the ones out of the list only link the others, and are not solved). */
+  for (Constraint const& cnst : cnst_list)
+    for (Element const& elem : cnst.enabled_element_set)
+      elem.variable->cnsts[0].constraint->rank = -1;
+  std::vector<int> parent;
+  int index = 0;
+  for (Constraint& cnst : cnst_list) {
+    cnst.rank = index;
+    parent.push_back(index);
+    index++;
+  }
+  for (Constraint const& cnst : cnst_list)
+    for (Element const& elem : cnst.enabled_element_set) {
+      Constraint* first = elem.variable->cnsts[0].constraint;
+      if (first->rank < 0) {
+        first->rank = index;
+        parent.push_back(index);
+        index++;
+      }
+    }
+  auto find_root = [&parent](int i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i         = parent[i];
+    }
+    return i;
+  };
+  for (Constraint const& cnst : cnst_list) {
+    for (Element const& elem : cnst.enabled_element_set) {
+      int root1 = find_root(cnst.rank);
+      int root2 = find_root(elem.variable->cnsts[0].constraint->rank);
+      if (root1 < root2)
+        parent[root2] = root1;
+      else if (root2 < root1)
+        parent[root1] = root2;
+    }
+  }
+
+  /* Components are sorted by their first constraint, and each component keeps the order of cnst_list */
+  std::vector<int> component_of(parent.size(), -1);
+  unsigned used = 0;
+  for (std::vector<Constraint*>& component : components_)
+    component.clear();
+  for (Constraint& cnst : cnst_list) {
+    int root = find_root(cnst.rank);
+    if (component_of[root] < 0) {
+      component_of[root] = used++;
+      if (components_.size() < used)
+        components_.emplace_back();
+    }
+    components_[component_of[root]].push_back(&cnst);
+  }
+  components_.resize(used);
+}
+
+void System::solve_component(std::vector<Constraint*>* component)
+{
+  auto cnst_list = boost::adaptors::indirect(*component);
+  SaturatedVariableList saturated_vars;
+  lmm_solve(cnst_list, saturated_vars, nullptr);
+}
+
+template <class CnstList>
+void System::lmm_solve(CnstList& cnst_list, SaturatedVariableList& saturated_vars,
+                       resource::Action::ModifiedSet* modified_set)
 {
   double min_usage = -1;
   double min_bound = -1;
@@ -527,8 +646,8 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
 
         elem.make_active();
         resource::Action* action = static_cast<resource::Action*>(elem.variable->id);
-        if (modified_set_ && not action->is_within_modified_set())
-          modified_set_->push_back(*action);
+        if (modified_set && not action->is_within_modified_set())
+          modified_set->push_back(*action);
       }
     }
     XBT_DEBUG("Constraint '%d' usage: %f remaining: %f concurrency: %i<=%i<=%i", cnst.id_int, cnst.usage,
@@ -547,12 +666,12 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
     }
   }
 
-  saturated_variable_set_update(cnst_light_tab, saturated_constraints, this);
+  saturated_variable_set_update(cnst_light_tab, saturated_constraints, saturated_vars);
 
   /* Saturated variables update */
   do {
     /* Fix the variables that have to be */
-    auto& var_list = saturated_variable_set;
+    auto& var_list = saturated_vars;
     for (Variable const& var : var_list) {
       if (var.sharing_weight <= 0.0)
         DIE_IMPOSSIBLE;
@@ -664,20 +783,10 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
       saturated_constraints_update(cnst_light_tab[pos].remaining_over_usage, pos, saturated_constraints, &min_usage);
     }
 
-    saturated_variable_set_update(cnst_light_tab, saturated_constraints, this);
+    saturated_variable_set_update(cnst_light_tab, saturated_constraints, saturated_vars);
 
   } while (cnst_light_num > 0);
 
-  modified_ = false;
-  if (selective_update_active)
-    remove_all_modified_set();
-
-  if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
-    print();
-  }
-
-  check_concurrency();
-
   delete[] cnst_light_tab;
 }
 
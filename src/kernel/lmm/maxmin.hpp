@@ -17,6 +17,9 @@
 #include <vector>
 
 namespace simgrid {
+namespace xbt {
+template <typename T> class Parmap;
+}
 namespace kernel {
 namespace lmm {
 
@@ -301,6 +304,7 @@ public:
   double lambda;
   double new_lambda;
   ConstraintLight* cnst_light;
+  int rank; /* index of the constraint in the arrays of the solvers (System::find_components() and FlatMaxMin) */
 
 private:
   static int Global_debug_id;
@@ -398,6 +402,7 @@ public:
   resource::Action* id;
   int id_int;
   unsigned visited; /* used by System::update_modified_set() */
+  int rank;         /* index of the variable in the arrays of FlatMaxMin */
   /* \begin{For Lagrange only} */
   double mu;
   double new_mu;
@@ -563,11 +568,26 @@ private:
   void update_modified_set(Constraint * cnst);
   void update_modified_set_rec(Constraint * cnst);
 
+protected:
   /** @brief Remove all constraints of the modified_constraint_set. */
   void remove_all_modified_set();
   void check_concurrency() const;
 
+private:
+
+  typedef boost::intrusive::list<Variable, boost::intrusive::member_hook<Variable, boost::intrusive::list_member_hook<>,
+                                                                         &Variable::saturated_variable_set_hook>>
+      SaturatedVariableList;
+
   template <class CnstList> void lmm_solve(CnstList& cnst_list);
+  template <class CnstList>
+  static void lmm_solve(CnstList& cnst_list, SaturatedVariableList& saturated_vars,
+                        resource::Action::ModifiedSet* modified_set);
+
+  /** @brief Split the constraints into the connected components of the constraint/variable graph (in components_) */
+  template <class CnstList> void find_components(CnstList& cnst_list);
+  /** @brief Solve one of the components_ on its own (called concurrently from the parmap_ workers) */
+  static void solve_component(std::vector<Constraint*>* component);
 
 public:
   bool modified_ = false;
@@ -577,28 +597,34 @@ public:
   boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
                                                                    &Constraint::active_constraint_set_hook>>
       active_constraint_set;
-  boost::intrusive::list<Variable, boost::intrusive::member_hook<Variable, boost::intrusive::list_member_hook<>,
-                                                                 &Variable::saturated_variable_set_hook>>
-      saturated_variable_set;
+  SaturatedVariableList saturated_variable_set;
   boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
                                                                    &Constraint::saturated_constraint_set_hook>>
       saturated_constraint_set;
 
   resource::Action::ModifiedSet* modified_set_ = nullptr;
 
-private:
+protected:
   bool selective_update_active; /* flag to update partially the system only selecting changed portions */
+  boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
+                                                                   &Constraint::modified_constraint_set_hook>>
+      modified_constraint_set;
+
+private:
   unsigned visited_counter_ = 1; /* used by System::update_modified_set() and System::remove_all_modified_set() to
                                   * cleverly (un-)flag the constraints (more details in these functions) */
   boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
                                                                    &Constraint::constraint_set_hook>>
       constraint_set;
-  boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
-                                                                   &Constraint::modified_constraint_set_hook>>
-      modified_constraint_set;
   xbt_mallocator_t variable_mallocator_ =
       xbt_mallocator_new(65536, System::variable_mallocator_new_f, System::variable_mallocator_free_f, nullptr);
   ;
+
+  /* Connected components of the last solved constraint set, and the worker pool solving them concurrently (only used
+   * when maxmin/split-components is set) */
+  std::vector<std::vector<Constraint*>> components_;
+  std::vector<std::vector<Constraint*>*> components_todo_;
+  xbt::Parmap<std::vector<Constraint*>*>* parmap_ = nullptr;
 };
 
 class XBT_PUBLIC FairBottleneck : public System {
@@ -610,6 +636,53 @@ private:
   void bottleneck_solve();
 };
 
+/**
+ * @brief Max-min solver working on a flat copy of the system
+ *
+ * Same sharing as System::lmm_solve(), but the saturation runs on contiguous arrays (CSR matrices of the elements,
+ * dense vectors of bounds, remainings and usages) instead of the linked lists of the system. This trades a copy of the
+ * modified part of the system at each resolution for cache-friendly saturation rounds, which pays off on large
+ * systems (many thousands of variables). Select it with --cfg=maxmin/solver:flat.
+ */
+class XBT_PUBLIC FlatMaxMin : public System {
+public:
+  explicit FlatMaxMin(bool selective_update) : System(selective_update) {}
+  void solve() final { flat_solve(); }
+
+private:
+  void flat_solve();
+  template <class CnstList> void build_arrays(CnstList& cnst_list);
+  void saturate();
+  void deactivate(unsigned cnst);
+  double fatpipe_usage(unsigned cnst) const;
+
+  /* Constraints, indexed by Constraint::rank */
+  std::vector<Constraint*> cnst_;
+  std::vector<double> bound_;
+  std::vector<double> remaining_;
+  std::vector<double> usage_;
+  std::vector<char> fatpipe_;
+  std::vector<unsigned> cnst_begin_; /* elements of cnst c are in [cnst_begin_[c], cnst_begin_[c+1]) */
+  std::vector<unsigned> elem_var_;   /* rank of the variable of each element */
+  std::vector<double> elem_share_;   /* consumption_weight / sharing_weight of each element */
+
+  /* Constraints still to be saturated, packed: active_ratio_[i] is remaining_ / usage_ of constraint active_[i] */
+  std::vector<unsigned> active_;
+  std::vector<double> active_ratio_;
+  std::vector<int> slot_; /* position of each constraint in active_, or -1 */
+
+  /* Variables, indexed by Variable::rank */
+  std::vector<Variable*> var_;
+  std::vector<double> weight_;
+  std::vector<double> var_bound_;
+  std::vector<double> value_;
+  std::vector<char> saturated_;
+  std::vector<unsigned> var_begin_;       /* constraints of var v are in [var_begin_[v], var_begin_[v+1]) */
+  std::vector<unsigned> var_cnst_;        /* rank of the constraint of each element */
+  std::vector<double> var_cnst_weight_;   /* consumption_weight of each element */
+  std::vector<unsigned> saturated_vars_;
+};
+
 class XBT_PUBLIC Lagrange : public System {
 public:
   explicit Lagrange(bool selective_update) : System(selective_update) {}
@@ -643,6 +716,7 @@ private:
 };
 
 XBT_PUBLIC System* make_new_maxmin_system(bool selective_update);
+XBT_PUBLIC System* make_new_flat_maxmin_system(bool selective_update);
 XBT_PUBLIC System* make_new_fair_bottleneck_system(bool selective_update);
 XBT_PUBLIC System* make_new_lagrange_system(bool selective_update);
 
@@ -8,265 +8,245 @@
 #include "src/surf/network_interface.hpp"
 #include "src/surf/xml/platf_private.hpp"
 #include "surf/surf.hpp"
+#include "xbt/config.hpp"
 
-#include <cfloat>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <queue>
+#include <unordered_set>
 #include <vector>
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_route_dijkstra, surf, "Routing part of surf -- dijkstra routing logic");
 
-/* Free functions */
-
-static void graph_node_data_free(void* n)
-{
-  delete static_cast<graph_node_data_t>(n);
-}
-
-static void graph_edge_data_free(void* e)
-{
-  delete static_cast<simgrid::kernel::routing::RouteCreationArgs*>(e);
-}
-
-/* Utility functions */
+static simgrid::config::Flag<int> cfg_dijkstra_nthreads{
+    "network/dijkstra-nthreads",
+    "Number of threads computing all the routes of the DijkstraCache netzones when they are sealed (0: compute the "
+    "routes when they are first used)",
+    0};
 
 namespace simgrid {
 namespace kernel {
 namespace routing {
 void DijkstraZone::seal()
 {
-  unsigned int cursor;
-  xbt_node_t node = nullptr;
-
-  /* Create the topology graph */
-  if (not route_graph_)
-    route_graph_ = xbt_graph_new_graph(1, nullptr);
-
   /* Add the loopback if needed */
   if (surf_network_model->loopback_ && hierarchy_ == RoutingMode::base) {
-    xbt_dynar_foreach (xbt_graph_get_nodes(route_graph_), cursor, node) {
-
-      bool found = false;
-      xbt_edge_t edge = nullptr;
-      unsigned int cursor2;
-      xbt_dynar_foreach (xbt_graph_node_get_outedges(node), cursor2, edge) {
-        if (xbt_graph_edge_get_target(edge) == node) {
-          found = true;
-          break;
-        }
-      }
-
-      if (not found) {
-        RouteCreationArgs* e_route = new simgrid::kernel::routing::RouteCreationArgs();
-        e_route->link_list.push_back(surf_network_model->loopback_);
-        xbt_graph_new_edge(route_graph_, node, node, e_route);
-      }
-    }
+    RouteCreationArgs loopback;
+    loopback.link_list.push_back(surf_network_model->loopback_);
+    unsigned route = routes_.add(loopback);
+    std::vector<bool> has_loopback(node_count_, false);
+    for (Edge const& edge : edges_)
+      if (edge.src == edge.dst)
+        has_loopback[edge.src] = true;
+    for (unsigned node = 0; node < node_count_; node++)
+      if (not has_loopback[node])
+        edges_.push_back({node, node, 1, route});
   }
+  routes_.shrink();
 
-  /* initialize graph indexes in nodes after graph has been built */
-  xbt_dynar_t nodes = xbt_graph_get_nodes(route_graph_);
+  build_graph();
 
-  xbt_dynar_foreach (nodes, cursor, node) {
-    graph_node_data_t data = static_cast<graph_node_data_t>(xbt_graph_node_get_data(node));
-    data->graph_id         = cursor;
-  }
+  if (cached_ && cfg_dijkstra_nthreads > 0)
+    precompute_predecessors(cfg_dijkstra_nthreads);
 }
 
-xbt_node_t DijkstraZone::routeGraphNewNode(int id, int graph_id)
+int DijkstraZone::get_node(NetPoint* netpoint)
 {
-  graph_node_data_t data = new s_graph_node_data_t;
-  data->id       = id;
-  data->graph_id = graph_id;
-
-  xbt_node_t node = xbt_graph_new_node(route_graph_, data);
-  graph_node_map_.emplace(id, node);
+  return netpoint->id() < graph_node_of_.size() ? graph_node_of_[netpoint->id()] : -1;
+}
 
-  return node;
+unsigned DijkstraZone::new_node(NetPoint* netpoint)
+{
+  int node = get_node(netpoint);
+  if (node != -1)
+    return node;
+  if (netpoint->id() >= graph_node_of_.size())
+    graph_node_of_.resize(netpoint->id() + 1, -1);
+  graph_node_of_[netpoint->id()] = node_count_;
+  return node_count_++;
 }
 
-xbt_node_t DijkstraZone::nodeMapSearch(int id)
+/** @brief Returns the first declared edge from src to dst, or -1 */
+int DijkstraZone::find_edge(unsigned src, unsigned dst)
 {
-  auto ret = graph_node_map_.find(id);
-  return ret == graph_node_map_.end() ? nullptr : ret->second;
+  for (unsigned i = out_begin_[src]; i < out_begin_[src + 1]; i++)
+    if (edges_[out_edges_[i]].dst == dst)
+      return out_edges_[i];
+  return -1;
 }
 
 /* Parsing */
 
-void DijkstraZone::newRoute(int src_id, int dst_id, simgrid::kernel::routing::RouteCreationArgs* e_route)
+void DijkstraZone::new_edge(unsigned src, unsigned dst, RouteCreationArgs* e_route)
 {
-  XBT_DEBUG("Load Route from \"%d\" to \"%d\"", src_id, dst_id);
-  xbt_node_t src = nullptr;
-  xbt_node_t dst = nullptr;
-
-  xbt_node_t src_elm = nodeMapSearch(src_id);
-  xbt_node_t dst_elm = nodeMapSearch(dst_id);
-
-  if (src_elm)
-    src = src_elm;
+  XBT_DEBUG("Load Route from \"%u\" to \"%u\"", src, dst);
+  edges_.push_back({src, dst, static_cast<unsigned>(e_route->link_list.size()), routes_.add(*e_route)});
+  declared_edges_.insert(static_cast<unsigned long long>(src) << 32 | dst);
+  delete e_route;
+}
 
-  if (dst_elm)
-    dst = dst_elm;
+/** @brief Builds the compressed adjacency of the graph: the out edges of each node, in declaration order */
+void DijkstraZone::build_graph()
+{
+  out_begin_.assign(node_count_ + 1, 0);
+  for (Edge const& edge : edges_)
+    out_begin_[edge.src + 1]++;
+  for (unsigned node = 0; node < node_count_; node++)
+    out_begin_[node + 1] += out_begin_[node];
+
+  out_edges_.resize(edges_.size());
+  std::vector<unsigned> next(out_begin_.begin(), out_begin_.end() - 1);
+  for (unsigned i = 0; i < edges_.size(); i++)
+    out_edges_[next[edges_[i].src]++] = i;
+
+  route_cache_.clear();
+  route_cache_.resize(node_count_);
+  std::unordered_set<unsigned long long>().swap(declared_edges_);
+}
 
-  /* add nodes if they don't exist in the graph */
-  if (src_id == dst_id && src == nullptr && dst == nullptr) {
-    src = this->routeGraphNewNode(src_id, -1);
-    dst = src;
-  } else {
-    if (src == nullptr) {
-      src = this->routeGraphNewNode(src_id, -1);
-    }
-    if (dst == nullptr) {
-      dst = this->routeGraphNewNode(dst_id, -1);
+/** @brief Computes the shortest paths from src, as the edge reaching each node on them (or -1 if unreachable) */
+void DijkstraZone::compute_predecessors(unsigned src, std::vector<int>& pred_edge) const
+{
+  constexpr unsigned no_cost = std::numeric_limits<unsigned>::max();
+  std::vector<unsigned> cost_arr(node_count_, no_cost); /* link cost from src to other hosts */
+  pred_edge.assign(node_count_, -1);                    /* edges reaching each node in path from src */
+  typedef std::pair<unsigned, unsigned> Qelt;
+  std::priority_queue<Qelt, std::vector<Qelt>, std::greater<Qelt>> pqueue;
+
+  cost_arr[src] = 0;
+  pqueue.emplace(0, src);
+
+  /* apply dijkstra using the indexes from the graph's node array */
+  while (not pqueue.empty()) {
+    Qelt top = pqueue.top();
+    pqueue.pop();
+    unsigned v_id = top.second;
+    if (top.first > cost_arr[v_id]) // outdated entry, v_id was reached through a shorter path since then
+      continue;
+
+    for (unsigned i = out_begin_[v_id]; i < out_begin_[v_id + 1]; i++) {
+      Edge const& edge = edges_[out_edges_[i]];
+      if (cost_arr[v_id] + edge.cost < cost_arr[edge.dst]) {
+        pred_edge[edge.dst] = out_edges_[i];
+        cost_arr[edge.dst]  = cost_arr[v_id] + edge.cost;
+        pqueue.emplace(cost_arr[edge.dst], edge.dst);
+      }
     }
   }
+}
 
-  /* add link as edge to graph */
-  xbt_graph_new_edge(route_graph_, src, dst, e_route);
+/** @brief Fills the cache with the paths from every node, computed by several threads */
+void DijkstraZone::precompute_predecessors(unsigned nthreads)
+{
+  XBT_DEBUG("Compute the routes from the %u nodes of %s on %u threads", node_count_, get_cname(), nthreads);
+  struct Job {
+    DijkstraZone* zone;
+    std::atomic<unsigned> next_src{0};
+  } job;
+  job.zone = this;
+  auto worker_main = [](void* arg) -> void* {
+    Job* job = static_cast<Job*>(arg);
+    for (unsigned src = job->next_src++; src < job->zone->node_count_; src = job->next_src++)
+      job->zone->compute_predecessors(src, job->zone->route_cache_[src]);
+    return nullptr;
+  };
+
+  std::vector<xbt_os_thread_t> threads;
+  for (unsigned i = 1; i < nthreads; i++)
+    threads.push_back(xbt_os_thread_create("dijkstra worker", worker_main, &job, nullptr));
+  worker_main(&job);
+  for (xbt_os_thread_t thread : threads)
+    xbt_os_thread_join(thread, nullptr);
 }
 
 void DijkstraZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* route, double* lat)
 {
   getRouteCheckParams(src, dst);
-  int src_id = src->id();
-  int dst_id = dst->id();
-
-  xbt_dynar_t nodes = xbt_graph_get_nodes(route_graph_);
 
   /* Use the graph_node id mapping set to quickly find the nodes */
-  xbt_node_t src_elm = nodeMapSearch(src_id);
-  xbt_node_t dst_elm = nodeMapSearch(dst_id);
+  int src_node_id = get_node(src);
+  int dst_node_id = get_node(dst);
+  if (src_node_id == -1 || dst_node_id == -1)
+    THROWF(arg_error, 0, "No route from '%s' to '%s'", src->get_cname(), dst->get_cname());
 
-  int src_node_id = static_cast<graph_node_data_t>(xbt_graph_node_get_data(src_elm))->graph_id;
-  int dst_node_id = static_cast<graph_node_data_t>(xbt_graph_node_get_data(dst_elm))->graph_id;
+  /* The links are collected from dst back to src, in this reversed order */
+  std::vector<resource::LinkImpl*> path;
 
   /* if the src and dst are the same */
   if (src_node_id == dst_node_id) {
-
-    xbt_node_t node_s_v = xbt_dynar_get_as(nodes, src_node_id, xbt_node_t);
-    xbt_node_t node_e_v = xbt_dynar_get_as(nodes, dst_node_id, xbt_node_t);
-    xbt_edge_t edge     = xbt_graph_get_edge(route_graph_, node_s_v, node_e_v);
-
-    if (edge == nullptr)
+    int edge = find_edge(src_node_id, dst_node_id);
+    if (edge == -1)
       THROWF(arg_error, 0, "No route from '%s' to '%s'", src->get_cname(), dst->get_cname());
-
-    RouteCreationArgs* e_route = static_cast<RouteCreationArgs*>(xbt_graph_edge_get_data(edge));
-
-    for (auto const& link : e_route->link_list) {
-      route->link_list.insert(route->link_list.begin(), link);
-      if (lat)
-        *lat += static_cast<resource::LinkImpl*>(link)->get_latency();
-    }
+    routes_.get_links(edges_[edge].route, path, lat);
   }
 
-  auto elm                   = route_cache_.emplace(src_id, std::vector<int>());
-  std::vector<int>& pred_arr = elm.first->second;
-
-  if (elm.second) { /* new element was inserted (not cached mode, or cache miss) */
-    int nr_nodes      = xbt_dynar_length(nodes);
-    std::vector<double> cost_arr(nr_nodes); /* link cost from src to other hosts */
-    pred_arr.resize(nr_nodes);              /* predecessors in path from src */
-    typedef std::pair<double, int> Qelt;
-    std::priority_queue<Qelt, std::vector<Qelt>, std::greater<Qelt>> pqueue;
-
-    /* initialize */
-    cost_arr[src_node_id] = 0.0;
-
-    for (int i = 0; i < nr_nodes; i++) {
-      if (i != src_node_id) {
-        cost_arr[i] = DBL_MAX;
-      }
-
-      pred_arr[i] = 0;
-
-      /* initialize priority queue */
-      pqueue.emplace(cost_arr[i], i);
-    }
-
-    /* apply dijkstra using the indexes from the graph's node array */
-    while (not pqueue.empty()) {
-      int v_id = pqueue.top().second;
-      pqueue.pop();
-      xbt_node_t v_node = xbt_dynar_get_as(nodes, v_id, xbt_node_t);
-      xbt_edge_t edge   = nullptr;
-      unsigned int cursor;
-
-      xbt_dynar_foreach (xbt_graph_node_get_outedges(v_node), cursor, edge) {
-        xbt_node_t u_node                  = xbt_graph_edge_get_target(edge);
-        graph_node_data_t data             = static_cast<graph_node_data_t>(xbt_graph_node_get_data(u_node));
-        int u_id                           = data->graph_id;
-        RouteCreationArgs* tmp_e_route     = static_cast<RouteCreationArgs*>(xbt_graph_edge_get_data(edge));
-        int cost_v_u                       = tmp_e_route->link_list.size(); /* count of links, old model assume 1 */
-
-        if (cost_v_u + cost_arr[v_id] < cost_arr[u_id]) {
-          pred_arr[u_id] = v_id;
-          cost_arr[u_id] = cost_v_u + cost_arr[v_id];
-          pqueue.emplace(cost_arr[u_id], u_id);
-        }
-      }
+  std::vector<int> computed;
+  const std::vector<int>* pred_arr = &computed;
+  if (cached_) {
+    /* Compute the paths out of the lock, in case another thread looks for other routes meanwhile */
+    xbt_os_mutex_acquire(cache_mutex_);
+    bool known = not route_cache_[src_node_id].empty();
+    xbt_os_mutex_release(cache_mutex_);
+    if (not known) {
+      compute_predecessors(src_node_id, computed);
+      xbt_os_mutex_acquire(cache_mutex_);
+      if (route_cache_[src_node_id].empty())
+        route_cache_[src_node_id] = std::move(computed);
+      xbt_os_mutex_release(cache_mutex_);
     }
+    pred_arr = &route_cache_[src_node_id];
+  } else {
+    compute_predecessors(src_node_id, computed);
   }
 
   /* compose route path with links */
-  NetPoint* gw_src = nullptr;
-  NetPoint* gw_dst;
-  NetPoint* first_gw            = nullptr;
+  NetPoint* gw_src   = nullptr;
+  NetPoint* gw_dst   = nullptr;
+  NetPoint* first_gw = nullptr;
 
-  for (int v = dst_node_id; v != src_node_id; v = pred_arr[v]) {
-    xbt_node_t node_pred_v = xbt_dynar_get_as(nodes, pred_arr[v], xbt_node_t);
-    xbt_node_t node_v      = xbt_dynar_get_as(nodes, v, xbt_node_t);
-    xbt_edge_t edge        = xbt_graph_get_edge(route_graph_, node_pred_v, node_v);
-
-    if (edge == nullptr)
+  for (int v = dst_node_id; v != src_node_id; v = edges_[(*pred_arr)[v]].src) {
+    if ((*pred_arr)[v] == -1)
       THROWF(arg_error, 0, "No route from '%s' to '%s'", src->get_cname(), dst->get_cname());
 
-    RouteCreationArgs* e_route = static_cast<RouteCreationArgs*>(xbt_graph_edge_get_data(edge));
-
-    NetPoint* prev_gw_src          = gw_src;
-    gw_src                         = e_route->gw_src;
-    gw_dst                         = e_route->gw_dst;
+    unsigned e_route      = edges_[(*pred_arr)[v]].route;
+    NetPoint* prev_gw_src = gw_src;
+    gw_src                = routes_.get_gw_src(e_route);
+    gw_dst                = routes_.get_gw_dst(e_route);
 
     if (v == dst_node_id)
       first_gw = gw_dst;
 
     if (hierarchy_ == RoutingMode::recursive && v != dst_node_id && gw_dst->get_name() != prev_gw_src->get_name()) {
       std::vector<resource::LinkImpl*> e_route_as_to_as;
-
-      NetPoint* gw_dst_net_elm      = nullptr;
-      NetPoint* prev_gw_src_net_elm = nullptr;
-      get_global_route(gw_dst_net_elm, prev_gw_src_net_elm, e_route_as_to_as, nullptr);
-      auto pos = route->link_list.begin();
-      for (auto const& link : e_route_as_to_as) {
-        route->link_list.insert(pos, link);
+      get_global_route(gw_dst, prev_gw_src, e_route_as_to_as, nullptr);
+      for (auto const& link : e_route_as_to_as)
         if (lat)
           *lat += link->get_latency();
-        pos++;
-      }
+      path.insert(path.end(), e_route_as_to_as.rbegin(), e_route_as_to_as.rend());
     }
 
-    for (auto const& link : e_route->link_list) {
-      route->link_list.insert(route->link_list.begin(), link);
-      if (lat)
-        *lat += static_cast<resource::LinkImpl*>(link)->get_latency();
-    }
+    routes_.get_links(e_route, path, lat);
   }
 
+  route->link_list.insert(route->link_list.begin(), path.rbegin(), path.rend());
+
   if (hierarchy_ == RoutingMode::recursive) {
     route->gw_src = gw_src;
     route->gw_dst = first_gw;
   }
-
-  if (not cached_)
-    route_cache_.clear();
 }
 
 DijkstraZone::~DijkstraZone()
 {
-  xbt_graph_free_graph(route_graph_, &graph_node_data_free, &graph_edge_data_free, nullptr);
+  xbt_os_mutex_destroy(cache_mutex_);
 }
 
 /* Creation routing model functions */
 
-DijkstraZone::DijkstraZone(NetZone* father, std::string name, bool cached) : RoutedZone(father, name), cached_(cached)
+DijkstraZone::DijkstraZone(NetZone* father, std::string name, bool cached)
+    : RoutedZone(father, name), cached_(cached), cache_mutex_(xbt_os_mutex_init())
 {
 }
 
@@ -278,32 +258,26 @@ void DijkstraZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, Net
 
   addRouteCheckParams(src, dst, gw_src, gw_dst, link_list, symmetrical);
 
-  /* Create the topology graph */
-  if (not route_graph_)
-    route_graph_ = xbt_graph_new_graph(1, nullptr);
-
   /* we don't check whether the route already exist, because the algorithm may find another path through some other
    * nodes */
 
   /* Add the route to the base */
-  RouteCreationArgs* e_route = newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 1);
-  newRoute(src->id(), dst->id(), e_route);
+  unsigned src_node = new_node(src);
+  unsigned dst_node = new_node(dst);
+  new_edge(src_node, dst_node, newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 1));
 
   // Symmetrical YES
-  if (symmetrical == true) {
-
-    xbt_dynar_t nodes   = xbt_graph_get_nodes(route_graph_);
-    xbt_node_t node_s_v = xbt_dynar_get_as(nodes, src->id(), xbt_node_t);
-    xbt_node_t node_e_v = xbt_dynar_get_as(nodes, dst->id(), xbt_node_t);
-    xbt_edge_t edge     = xbt_graph_get_edge(route_graph_, node_e_v, node_s_v);
+  if (symmetrical == true && src != dst) {
+    bool exists = declared_edges_.find(static_cast<unsigned long long>(dst_node) << 32 | src_node) !=
+                  declared_edges_.end();
 
     if (not gw_dst || not gw_src) {
       XBT_DEBUG("Load Route from \"%s\" to \"%s\"", dstName, srcName);
-      if (edge)
+      if (exists)
         THROWF(arg_error, 0, "Route from %s to %s already exists", dstName, srcName);
     } else {
       XBT_DEBUG("Load NetzoneRoute from %s@%s to %s@%s", dstName, gw_dst->get_cname(), srcName, gw_src->get_cname());
-      if (edge)
+      if (exists)
         THROWF(arg_error, 0, "Route from %s@%s to %s@%s already exists", dstName, gw_dst->get_cname(), srcName,
                gw_src->get_cname());
     }
@@ -313,9 +287,7 @@ void DijkstraZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, Net
       gw_src           = gw_dst;
       gw_dst           = gw_tmp;
     }
-    RouteCreationArgs* link_route_back =
-        newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 0);
-    newRoute(dst->id(), src->id(), link_route_back);
+    new_edge(dst_node, src_node, newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 0));
   }
 }
 }
@@ -9,128 +9,243 @@
 #include "src/surf/xml/platf_private.hpp"
 #include "surf/surf.hpp"
 
-#include <cfloat>
+#include "xbt/config.hpp"
+#include "xbt/xbt_os_thread.h"
+
+#include <algorithm>
 #include <limits>
+#include <memory>
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_route_floyd, surf, "Routing part of surf");
 
-#define TO_FLOYD_COST(i, j) (cost_table_)[(i) + (j)*table_size]
-#define TO_FLOYD_PRED(i, j) (predecessor_table_)[(i) + (j)*table_size]
-#define TO_FLOYD_LINK(i, j) (link_table_)[(i) + (j)*table_size]
+static simgrid::config::Flag<int> cfg_floyd_nthreads{
+    "network/floyd-nthreads", "Number of threads computing the routes of the Floyd netzones", 1};
+
+#define TO_FLOYD_COST(i, j) (cost_table_)[(i) + static_cast<std::size_t>(j) * table_size]
+#define TO_FLOYD_PRED(i, j) (predecessor_table_)[(i) + static_cast<std::size_t>(j) * table_size]
+#define TO_FLOYD_LINK(i, j) (static_cast<unsigned long long>(i) << 32 | (j))
 
 namespace simgrid {
 namespace kernel {
 namespace routing {
 
-FloydZone::FloydZone(NetZone* father, std::string name) : RoutedZone(father, name)
+namespace {
+constexpr unsigned no_cost = std::numeric_limits<unsigned>::max();
+
+/** @brief Step c of the Floyd-Warshall algorithm, restricted to the columns [begin, end) of the tables.
+ *
+ * During this step, neither the row nor the column c can change, so that the columns can be updated independently.
+ * Each column is contiguous in memory.
+ */
+void floyd_step(unsigned table_size, unsigned* cost_table_, int* predecessor_table_, unsigned c, unsigned begin,
+                unsigned end)
 {
-  predecessor_table_ = nullptr;
-  cost_table_        = nullptr;
-  link_table_        = nullptr;
+  for (unsigned b = begin; b < end; b++) {
+    unsigned cost_cb = TO_FLOYD_COST(c, b);
+    if (cost_cb == no_cost)
+      continue;
+    int pred_cb = TO_FLOYD_PRED(c, b);
+    for (unsigned a = 0; a < table_size; a++) {
+      unsigned cost_ac = TO_FLOYD_COST(a, c);
+      if (cost_ac != no_cost && cost_ac + cost_cb < TO_FLOYD_COST(a, b)) {
+        TO_FLOYD_COST(a, b) = cost_ac + cost_cb;
+        TO_FLOYD_PRED(a, b) = pred_cb;
+      }
+    }
+  }
+}
+
+/** @brief Threads running the Floyd-Warshall algorithm together, each of them on its own range of columns */
+class FloydWorkers {
+public:
+  FloydWorkers(unsigned table_size, unsigned* cost_table, int* predecessor_table, unsigned nthreads)
+      : table_size_(table_size), cost_table_(cost_table), predecessor_table_(predecessor_table), nthreads_(nthreads)
+  {
+    mutex_ = xbt_os_mutex_init();
+    cond_  = xbt_os_cond_init();
+  }
+  ~FloydWorkers()
+  {
+    xbt_os_cond_destroy(cond_);
+    xbt_os_mutex_destroy(mutex_);
+  }
+
+  void run()
+  {
+    std::vector<xbt_os_thread_t> threads;
+    std::vector<std::pair<FloydWorkers*, unsigned>> args;
+    for (unsigned rank = 0; rank < nthreads_; rank++)
+      args.push_back({this, rank});
+    for (unsigned rank = 1; rank < nthreads_; rank++)
+      threads.push_back(xbt_os_thread_create("floyd worker", worker_main, &args[rank], nullptr));
+    worker_main(&args[0]);
+    for (xbt_os_thread_t thread : threads)
+      xbt_os_thread_join(thread, nullptr);
+  }
+
+private:
+  static void* worker_main(void* arg)
+  {
+    auto self          = static_cast<std::pair<FloydWorkers*, unsigned>*>(arg);
+    FloydWorkers* team = self->first;
+    unsigned begin     = static_cast<unsigned long long>(team->table_size_) * self->second / team->nthreads_;
+    unsigned end       = static_cast<unsigned long long>(team->table_size_) * (self->second + 1) / team->nthreads_;
+    for (unsigned c = 0; c < team->table_size_; c++) {
+      floyd_step(team->table_size_, team->cost_table_, team->predecessor_table_, c, begin, end);
+      team->barrier();
+    }
+    return nullptr;
+  }
+
+  /* Wait for all threads to complete the current step */
+  void barrier()
+  {
+    xbt_os_mutex_acquire(mutex_);
+    unsigned long step = step_;
+    if (++waiting_ == nthreads_) {
+      waiting_ = 0;
+      step_++;
+      xbt_os_cond_broadcast(cond_);
+    } else {
+      while (step == step_)
+        xbt_os_cond_wait(cond_, mutex_);
+    }
+    xbt_os_mutex_release(mutex_);
+  }
+
+  unsigned table_size_;
+  unsigned* cost_table_;
+  int* predecessor_table_;
+  unsigned nthreads_;
+  xbt_os_mutex_t mutex_;
+  xbt_os_cond_t cond_;
+  unsigned waiting_   = 0;
+  unsigned long step_ = 0;
+};
 }
 
-FloydZone::~FloydZone()
+FloydZone::FloydZone(NetZone* father, std::string name) : RoutedZone(father, name)
 {
-  if (link_table_ == nullptr) // Dealing with a parse error in the file?
-    return;
-  unsigned int table_size = get_table_size();
-  /* Delete link_table */
-  for (unsigned int i = 0; i < table_size; i++)
-    for (unsigned int j = 0; j < table_size; j++)
-      delete TO_FLOYD_LINK(i, j);
-  delete[] link_table_;
-
-  delete[] predecessor_table_;
-  delete[] cost_table_;
 }
 
 void FloydZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* route, double* lat)
 {
-  unsigned int table_size = get_table_size();
-
   getRouteCheckParams(src, dst);
 
   /* create a result route */
-  std::vector<RouteCreationArgs*> route_stack;
+  std::vector<unsigned> route_stack;
   unsigned int cur = dst->id();
   do {
-    int pred = TO_FLOYD_PRED(src->id(), cur);
+    int pred = get_predecessor(src->id(), cur);
     if (pred == -1)
       THROWF(arg_error, 0, "No route from '%s' to '%s'", src->get_cname(), dst->get_cname());
-    route_stack.push_back(TO_FLOYD_LINK(pred, cur));
+    route_stack.push_back(link_table_.at(TO_FLOYD_LINK(pred, cur)));
     cur = pred;
   } while (cur != src->id());
 
   if (hierarchy_ == RoutingMode::recursive) {
-    route->gw_src = route_stack.back()->gw_src;
-    route->gw_dst = route_stack.front()->gw_dst;
+    route->gw_src = routes_.get_gw_src(route_stack.back());
+    route->gw_dst = routes_.get_gw_dst(route_stack.front());
   }
 
   NetPoint* prev_dst_gw = nullptr;
   while (not route_stack.empty()) {
-    RouteCreationArgs* e_route = route_stack.back();
+    unsigned e_route = route_stack.back();
     route_stack.pop_back();
     if (hierarchy_ == RoutingMode::recursive && prev_dst_gw != nullptr &&
-        prev_dst_gw->get_cname() != e_route->gw_src->get_cname()) {
-      get_global_route(prev_dst_gw, e_route->gw_src, route->link_list, lat);
+        prev_dst_gw->get_cname() != routes_.get_gw_src(e_route)->get_cname()) {
+      get_global_route(prev_dst_gw, routes_.get_gw_src(e_route), route->link_list, lat);
     }
 
-    for (auto const& link : e_route->link_list) {
-      route->link_list.push_back(link);
-      if (lat)
-        *lat += link->get_latency();
-    }
+    routes_.get_links(e_route, route->link_list, lat);
 
-    prev_dst_gw = e_route->gw_dst;
+    prev_dst_gw = routes_.get_gw_dst(e_route);
   }
 }
 
-void FloydZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
-                          std::vector<resource::LinkImpl*>& link_list, bool symmetrical)
+int FloydZone::get_predecessor(unsigned src, unsigned dst) const
 {
-  /* set the size of table routing */
-  unsigned int table_size = get_table_size();
-
-  addRouteCheckParams(src, dst, gw_src, gw_dst, link_list, symmetrical);
+  const PredecessorColumn& column = pred_columns_[dst];
+  if (column.dense)
+    return pred_dense_[column.begin + src];
+  auto first = pred_sparse_.begin() + column.begin;
+  auto last  = pred_sparse_.begin() + column.end;
+  auto entry = std::lower_bound(first, last, static_cast<unsigned long long>(src) << 32);
+  if (entry != last && (*entry >> 32) == src)
+    return static_cast<int>(static_cast<unsigned>(*entry));
+  return column.common_pred;
+}
 
-  if (not link_table_) {
-    /* Create Cost, Predecessor and Link tables */
-    cost_table_        = new double[table_size * table_size];             /* link cost from host to host */
-    predecessor_table_ = new int[table_size * table_size];                /* predecessor host numbers */
-    link_table_        = new RouteCreationArgs*[table_size * table_size]; /* actual link between src and dst */
+void FloydZone::compress_predecessors(const std::vector<int>& predecessor_table_)
+{
+  unsigned table_size = get_table_size();
+  std::vector<unsigned> counts(table_size + 1, 0); // indexed by pred + 1, as pred may be -1
 
-    /* Initialize costs and predecessors */
-    for (unsigned int i = 0; i < table_size; i++)
-      for (unsigned int j = 0; j < table_size; j++) {
-        TO_FLOYD_COST(i, j) = DBL_MAX;
-        TO_FLOYD_PRED(i, j) = -1;
-        TO_FLOYD_LINK(i, j) = nullptr;
+  pred_columns_.resize(table_size);
+  for (unsigned b = 0; b < table_size; b++) {
+    /* Find the most common predecessor of the column */
+    int common_pred    = -1;
+    unsigned max_count = 0;
+    for (unsigned a = 0; a < table_size; a++) {
+      unsigned count = ++counts[TO_FLOYD_PRED(a, b) + 1];
+      if (count > max_count) {
+        max_count   = count;
+        common_pred = TO_FLOYD_PRED(a, b);
       }
+    }
+    for (unsigned a = 0; a < table_size; a++)
+      counts[TO_FLOYD_PRED(a, b) + 1] = 0;
+
+    /* Each sparse entry takes twice the size of a dense one */
+    PredecessorColumn& column = pred_columns_[b];
+    column.common_pred        = common_pred;
+    column.dense              = 2 * (table_size - max_count) >= table_size;
+    if (column.dense) {
+      column.begin = pred_dense_.size();
+      pred_dense_.insert(pred_dense_.end(), &TO_FLOYD_PRED(0, b), &TO_FLOYD_PRED(0, b) + table_size);
+      column.end = pred_dense_.size();
+    } else {
+      column.begin = pred_sparse_.size();
+      for (unsigned a = 0; a < table_size; a++)
+        if (TO_FLOYD_PRED(a, b) != common_pred)
+          pred_sparse_.push_back(static_cast<unsigned long long>(a) << 32 |
+                                 static_cast<unsigned>(TO_FLOYD_PRED(a, b)));
+      column.end = pred_sparse_.size();
+    }
   }
+  pred_dense_.shrink_to_fit();
+  pred_sparse_.shrink_to_fit();
+  XBT_DEBUG("Predecessors of %s: %zu dense and %zu sparse entries instead of %zu", get_cname(), pred_dense_.size(),
+            pred_sparse_.size(), static_cast<std::size_t>(table_size) * table_size);
+}
+
+void FloydZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
+                          std::vector<resource::LinkImpl*>& link_list, bool symmetrical)
+{
+  addRouteCheckParams(src, dst, gw_src, gw_dst, link_list, symmetrical);
 
   /* Check that the route does not already exist */
   if (gw_dst) // netzone route (to adapt the error message, if any)
-    xbt_assert(nullptr == TO_FLOYD_LINK(src->id(), dst->id()),
+    xbt_assert(link_table_.find(TO_FLOYD_LINK(src->id(), dst->id())) == link_table_.end(),
                "The route between %s@%s and %s@%s already exists (Rq: routes are symmetrical by default).",
                src->get_cname(), gw_src->get_cname(), dst->get_cname(), gw_dst->get_cname());
   else
-    xbt_assert(nullptr == TO_FLOYD_LINK(src->id(), dst->id()),
+    xbt_assert(link_table_.find(TO_FLOYD_LINK(src->id(), dst->id())) == link_table_.end(),
                "The route between %s and %s already exists (Rq: routes are symmetrical by default).", src->get_cname(),
                dst->get_cname());
 
-  TO_FLOYD_LINK(src->id(), dst->id()) =
-      newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 1);
-  TO_FLOYD_PRED(src->id(), dst->id()) = src->id();
-  TO_FLOYD_COST(src->id(), dst->id()) = (TO_FLOYD_LINK(src->id(), dst->id()))->link_list.size();
+  std::unique_ptr<RouteCreationArgs> route(
+      newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 1));
+  link_table_[TO_FLOYD_LINK(src->id(), dst->id())] = routes_.add(*route);
 
   if (symmetrical == true) {
     if (gw_dst) // netzone route (to adapt the error message, if any)
       xbt_assert(
-          nullptr == TO_FLOYD_LINK(dst->id(), src->id()),
+          link_table_.find(TO_FLOYD_LINK(dst->id(), src->id())) == link_table_.end(),
           "The route between %s@%s and %s@%s already exists. You should not declare the reverse path as symmetrical.",
           dst->get_cname(), gw_dst->get_cname(), src->get_cname(), gw_src->get_cname());
     else
-      xbt_assert(nullptr == TO_FLOYD_LINK(dst->id(), src->id()),
+      xbt_assert(link_table_.find(TO_FLOYD_LINK(dst->id(), src->id())) == link_table_.end(),
                  "The route between %s and %s already exists. You should not declare the reverse path as symmetrical.",
                  dst->get_cname(), src->get_cname());
 
@@ -146,11 +261,8 @@ void FloydZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoi
       XBT_DEBUG("Load NetzoneRoute from \"%s(%s)\" to \"%s(%s)\"", dst->get_cname(), gw_src->get_cname(),
                 src->get_cname(), gw_dst->get_cname());
 
-    TO_FLOYD_LINK(dst->id(), src->id()) =
-        newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 0);
-    TO_FLOYD_PRED(dst->id(), src->id()) = dst->id();
-    TO_FLOYD_COST(dst->id(), src->id()) =
-        (TO_FLOYD_LINK(dst->id(), src->id()))->link_list.size(); /* count of links, old model assume 1 */
+    route.reset(newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 0));
+    link_table_[TO_FLOYD_LINK(dst->id(), src->id())] = routes_.add(*route);
   }
 }
 
@@ -159,47 +271,39 @@ void FloydZone::seal()
   /* set the size of table routing */
   unsigned int table_size = get_table_size();
 
-  if (not link_table_) {
-    /* Create Cost, Predecessor and Link tables */
-    cost_table_        = new double[table_size * table_size];             /* link cost from host to host */
-    predecessor_table_ = new int[table_size * table_size];                /* predecessor host numbers */
-    link_table_        = new RouteCreationArgs*[table_size * table_size]; /* actual link between src and dst */
-
-    /* Initialize costs and predecessors */
+  /* Add the loopback if needed */
+  if (surf_network_model->loopback_ && hierarchy_ == RoutingMode::base) {
+    RouteCreationArgs loopback;
+    loopback.link_list.push_back(surf_network_model->loopback_);
+    unsigned e_route = routes_.add(loopback);
     for (unsigned int i = 0; i < table_size; i++)
-      for (unsigned int j = 0; j < table_size; j++) {
-        TO_FLOYD_COST(i, j) = DBL_MAX;
-        TO_FLOYD_PRED(i, j) = -1;
-        TO_FLOYD_LINK(i, j) = nullptr;
-      }
+      link_table_.insert({TO_FLOYD_LINK(i, i), e_route});
   }
 
-  /* Add the loopback if needed */
-  if (surf_network_model->loopback_ && hierarchy_ == RoutingMode::base) {
-    for (unsigned int i = 0; i < table_size; i++) {
-      RouteCreationArgs* e_route = TO_FLOYD_LINK(i, i);
-      if (not e_route) {
-        e_route = new RouteCreationArgs();
-        e_route->link_list.push_back(surf_network_model->loopback_);
-        TO_FLOYD_LINK(i, i) = e_route;
-        TO_FLOYD_PRED(i, i) = i;
-        TO_FLOYD_COST(i, i) = 1;
-      }
-    }
+  /* The dense tables only exist while computing the paths: the 1-hop routes are their initial values */
+  std::vector<unsigned> cost_table_(static_cast<std::size_t>(table_size) * table_size, no_cost);
+  std::vector<int> predecessor_table_(static_cast<std::size_t>(table_size) * table_size, -1);
+  for (auto const& elm : link_table_) {
+    unsigned src            = elm.first >> 32;
+    unsigned dst            = static_cast<unsigned>(elm.first);
+    TO_FLOYD_PRED(src, dst) = src;
+    TO_FLOYD_COST(src, dst) = routes_.get_size(elm.second); /* count of links, old model assume 1 */
   }
+  routes_.shrink();
+
   /* Calculate path costs */
-  for (unsigned int c = 0; c < table_size; c++) {
-    for (unsigned int a = 0; a < table_size; a++) {
-      for (unsigned int b = 0; b < table_size; b++) {
-        if (TO_FLOYD_COST(a, c) < DBL_MAX && TO_FLOYD_COST(c, b) < DBL_MAX &&
-            (fabs(TO_FLOYD_COST(a, b) - DBL_MAX) < std::numeric_limits<double>::epsilon() ||
-             (TO_FLOYD_COST(a, c) + TO_FLOYD_COST(c, b) < TO_FLOYD_COST(a, b)))) {
-          TO_FLOYD_COST(a, b) = TO_FLOYD_COST(a, c) + TO_FLOYD_COST(c, b);
-          TO_FLOYD_PRED(a, b) = TO_FLOYD_PRED(c, b);
-        }
-      }
-    }
+  unsigned nthreads = std::max(1, std::min<int>(cfg_floyd_nthreads, table_size));
+  if (nthreads > 1) {
+    XBT_DEBUG("Compute the routes of %s on %u threads", get_cname(), nthreads);
+    FloydWorkers(table_size, cost_table_.data(), predecessor_table_.data(), nthreads).run();
+  } else {
+    for (unsigned int c = 0; c < table_size; c++)
+      floyd_step(table_size, cost_table_.data(), predecessor_table_.data(), c, 0, table_size);
   }
+
+  /* The costs are only needed to compute the predecessors */
+  std::vector<unsigned>().swap(cost_table_);
+  compress_predecessors(predecessor_table_);
 }
 }
 }
@@ -9,9 +9,11 @@
 #include "src/surf/xml/platf_private.hpp"
 #include "surf/surf.hpp"
 
+#include <memory>
+
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_route_full, surf, "Routing part of surf");
 
-#define TO_ROUTE_FULL(i, j) routing_table_[(i) + (j)*table_size]
+#define TO_ROUTE_FULL(i, j) routing_table_[(i) + static_cast<std::size_t>(j) * table_size]
 
 namespace simgrid {
 namespace kernel {
@@ -25,49 +27,33 @@ void FullZone::seal()
   unsigned int table_size = get_table_size();
 
   /* Create table if needed */
-  if (not routing_table_)
-    routing_table_ = new RouteCreationArgs*[table_size * table_size]();
+  if (routing_table_.empty())
+    routing_table_.resize(static_cast<std::size_t>(table_size) * table_size, 0);
 
   /* Add the loopback if needed */
   if (surf_network_model->loopback_ && hierarchy_ == RoutingMode::base) {
+    RouteCreationArgs loopback;
+    loopback.link_list.push_back(surf_network_model->loopback_);
+    unsigned route = routes_.add(loopback) + 1;
     for (unsigned int i = 0; i < table_size; i++) {
-      RouteCreationArgs* e_route = TO_ROUTE_FULL(i, i);
-      if (not e_route) {
-        e_route = new RouteCreationArgs();
-        e_route->link_list.push_back(surf_network_model->loopback_);
-        TO_ROUTE_FULL(i, i) = e_route;
-      }
+      if (TO_ROUTE_FULL(i, i) == 0)
+        TO_ROUTE_FULL(i, i) = route;
     }
   }
-}
-
-FullZone::~FullZone()
-{
-  if (routing_table_) {
-    unsigned int table_size = get_table_size();
-    /* Delete routing table */
-    for (unsigned int i = 0; i < table_size; i++)
-      for (unsigned int j = 0; j < table_size; j++)
-        delete TO_ROUTE_FULL(i, j);
-    delete[] routing_table_;
-  }
+  routes_.shrink();
 }
 
 void FullZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* res, double* lat)
 {
   XBT_DEBUG("full getLocalRoute from %s[%u] to %s[%u]", src->get_cname(), src->id(), dst->get_cname(), dst->id());
 
-  unsigned int table_size        = get_table_size();
-  RouteCreationArgs* e_route     = TO_ROUTE_FULL(src->id(), dst->id());
+  unsigned int table_size = get_table_size();
+  unsigned route          = TO_ROUTE_FULL(src->id(), dst->id());
 
-  if (e_route != nullptr) {
-    res->gw_src = e_route->gw_src;
-    res->gw_dst = e_route->gw_dst;
-    for (auto const& link : e_route->link_list) {
-      res->link_list.push_back(link);
-      if (lat)
-        *lat += link->get_latency();
-    }
+  if (route != 0) {
+    res->gw_src = routes_.get_gw_src(route - 1);
+    res->gw_dst = routes_.get_gw_dst(route - 1);
+    routes_.get_links(route - 1, res->link_list, lat);
   }
 }
 
@@ -78,22 +64,23 @@ void FullZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoin
 
   unsigned int table_size = get_table_size();
 
-  if (not routing_table_)
-    routing_table_ = new RouteCreationArgs*[table_size * table_size]();
+  if (routing_table_.empty())
+    routing_table_.resize(static_cast<std::size_t>(table_size) * table_size, 0);
 
   /* Check that the route does not already exist */
   if (gw_dst) // inter-zone route (to adapt the error message, if any)
-    xbt_assert(nullptr == TO_ROUTE_FULL(src->id(), dst->id()),
+    xbt_assert(0 == TO_ROUTE_FULL(src->id(), dst->id()),
                "The route between %s@%s and %s@%s already exists (Rq: routes are symmetrical by default).",
                src->get_cname(), gw_src->get_cname(), dst->get_cname(), gw_dst->get_cname());
   else
-    xbt_assert(nullptr == TO_ROUTE_FULL(src->id(), dst->id()),
+    xbt_assert(0 == TO_ROUTE_FULL(src->id(), dst->id()),
                "The route between %s and %s already exists (Rq: routes are symmetrical by default).", src->get_cname(),
                dst->get_cname());
 
   /* Add the route to the base */
-  TO_ROUTE_FULL(src->id(), dst->id()) =
-      newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, true);
+  std::unique_ptr<RouteCreationArgs> route(
+      newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, true));
+  TO_ROUTE_FULL(src->id(), dst->id()) = routes_.add(*route) + 1;
 
   if (symmetrical == true && src != dst) {
     if (gw_dst && gw_src) {
@@ -103,16 +90,16 @@ void FullZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoin
     }
     if (gw_dst && gw_src) // inter-zone route (to adapt the error message, if any)
       xbt_assert(
-          nullptr == TO_ROUTE_FULL(dst->id(), src->id()),
+          0 == TO_ROUTE_FULL(dst->id(), src->id()),
           "The route between %s@%s and %s@%s already exists. You should not declare the reverse path as symmetrical.",
           dst->get_cname(), gw_dst->get_cname(), src->get_cname(), gw_src->get_cname());
     else
-      xbt_assert(nullptr == TO_ROUTE_FULL(dst->id(), src->id()),
+      xbt_assert(0 == TO_ROUTE_FULL(dst->id(), src->id()),
                  "The route between %s and %s already exists. You should not declare the reverse path as symmetrical.",
                  dst->get_cname(), src->get_cname());
 
-    TO_ROUTE_FULL(dst->id(), src->id()) =
-        newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, false);
+    route.reset(newExtendedRoute(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, false));
+    TO_ROUTE_FULL(dst->id(), src->id()) = routes_.add(*route) + 1;
   }
 }
 }
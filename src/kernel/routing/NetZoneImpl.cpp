@@ -11,13 +11,105 @@
 #include "src/surf/network_interface.hpp"
 #include "src/surf/xml/platf_private.hpp"
 #include "surf/surf.hpp"
+#include "xbt/config.hpp"
+
+#include <list>
+#include <unordered_map>
 
 XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(surf_route);
+XBT_LOG_NEW_SUBCATEGORY(surf_route_cache, surf_route, "Cache of the routes between hosts");
+
+static simgrid::config::Flag<int> cfg_route_cache_size{
+    "network/route-cache", "Maximal amount of routes kept in the route cache (0 to disable the cache)", 0};
 
 namespace simgrid {
 namespace kernel {
 namespace routing {
 
+namespace {
+/** @brief Bounded cache of the global routes, dropping the least recently used ones when full
+ *
+ * Only the links are stored, along with the latency computed when the route was resolved. The whole cache is
+ * invalidated whenever the platform changes: creation or sealing of a netzone, addition of a route, or change of the
+ * latency of a link.
+ */
+class RouteCache {
+public:
+  struct Route {
+    std::vector<resource::LinkImpl*> links;
+    double latency;
+  };
+
+  RouteCache()
+  {
+    s4u::NetZone::on_creation.connect([this](s4u::NetZone&) { clear(); });
+    s4u::NetZone::on_seal.connect([this](s4u::NetZone&) { clear(); });
+    s4u::NetZone::on_route_creation.connect(
+        [this](bool, NetPoint*, NetPoint*, NetPoint*, NetPoint*, std::vector<resource::LinkImpl*>&) { clear(); });
+    s4u::on_simulation_end.connect([this]() {
+      unsigned long total = hits + misses;
+      XBT_CVERB(surf_route_cache, "%lu routes resolved: %lu found in the cache, %lu computed (hit rate: %.1f%%)",
+                total, hits, misses, total > 0 ? 100.0 * hits / total : 0.0);
+    });
+  }
+
+  /** Returns the cached route from src to dst (marking it as the most recently used one), or nullptr */
+  const Route* find(NetPoint* src, NetPoint* dst)
+  {
+    auto it = index_.find({src, dst});
+    if (it == index_.end()) {
+      misses++;
+      return nullptr;
+    }
+    hits++;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->second;
+  }
+
+  const Route* insert(NetPoint* src, NetPoint* dst, std::vector<resource::LinkImpl*>&& links, double latency,
+                      unsigned size)
+  {
+    while (lru_.size() >= size) {
+      index_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+    lru_.emplace_front(Key(src, dst), Route{std::move(links), latency});
+    index_.insert({lru_.front().first, lru_.begin()});
+    return &lru_.front().second;
+  }
+
+  void clear()
+  {
+    if (not lru_.empty())
+      XBT_CDEBUG(surf_route_cache, "Platform changed, forget the %zu cached routes", lru_.size());
+    index_.clear();
+    lru_.clear();
+  }
+
+  unsigned long hits   = 0;
+  unsigned long misses = 0;
+
+private:
+  typedef std::pair<NetPoint*, NetPoint*> Key;
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const
+    {
+      std::size_t h = std::hash<NetPoint*>()(key.first);
+      return h ^ (std::hash<NetPoint*>()(key.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+  };
+
+  std::list<std::pair<Key, Route>> lru_; // most recently used first
+  std::unordered_map<Key, std::list<std::pair<Key, Route>>::iterator, KeyHash> index_;
+};
+
+RouteCache& get_route_cache()
+{
+  static RouteCache cache;
+  return cache;
+}
+}
+
 class BypassRoute {
 public:
   explicit BypassRoute(NetPoint* gwSrc, NetPoint* gwDst) : gw_src(gwSrc), gw_dst(gwDst) {}
@@ -91,6 +183,7 @@ void NetZoneImpl::add_bypass_route(NetPoint* src, NetPoint* dst, NetPoint* gw_sr
 
   /* Store it */
   bypass_routes_.insert({{src, dst}, newRoute});
+  invalidate_route_cache();
 }
 
 /** @brief Get the common ancestor and its first children in each line leading to src and dst
@@ -313,6 +406,43 @@ bool NetZoneImpl::get_bypass_route(routing::NetPoint* src, routing::NetPoint* ds
 
 void NetZoneImpl::get_global_route(NetPoint* src, NetPoint* dst,
                                    /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency)
+{
+  int cache_size = cfg_route_cache_size;
+  if (cache_size <= 0) {
+    resolve_global_route(src, dst, links, latency);
+    return;
+  }
+
+  RouteCache& cache = get_route_cache();
+  const RouteCache::Route* cached = cache.find(src, dst);
+  if (cached == nullptr) {
+    std::vector<resource::LinkImpl*> route_links;
+    double route_latency = 0.0;
+    resolve_global_route(src, dst, route_links, &route_latency);
+    cached = cache.insert(src, dst, std::move(route_links), route_latency, cache_size);
+  }
+  links.insert(links.end(), cached->links.begin(), cached->links.end());
+  if (latency)
+    *latency += cached->latency;
+}
+
+void NetZoneImpl::invalidate_route_cache()
+{
+  get_route_cache().clear();
+}
+
+unsigned long NetZoneImpl::get_route_cache_hits()
+{
+  return get_route_cache().hits;
+}
+
+unsigned long NetZoneImpl::get_route_cache_misses()
+{
+  return get_route_cache().misses;
+}
+
+void NetZoneImpl::resolve_global_route(NetPoint* src, NetPoint* dst,
+                                       /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency)
 {
   RouteCreationArgs route;
 
@@ -12,8 +12,86 @@
 #include "src/surf/network_interface.hpp"
 #include "src/surf/xml/platf_private.hpp"
 
+#include <limits>
+
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_routing_generic, surf_route, "Generic implementation of the surf routing");
 
+namespace simgrid {
+namespace kernel {
+namespace routing {
+
+/* ***************************************************************** */
+/* ************************** ROUTE STORE ************************** */
+
+std::size_t RouteStore::KeyHash::operator()(const HopKey& key) const
+{
+  std::size_t h = std::hash<resource::LinkImpl*>()(key.first);
+  return h ^ (key.second + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+std::size_t RouteStore::KeyHash::operator()(const RouteKey& key) const
+{
+  std::size_t h = std::get<0>(key);
+  h ^= std::hash<NetPoint*>()(std::get<1>(key)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  h ^= std::hash<NetPoint*>()(std::get<2>(key)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  return h;
+}
+
+unsigned RouteStore::add(const RouteCreationArgs& route)
+{
+  /* Build the chain of hops from the end, reusing the already known suffixes */
+  unsigned next = 0;
+  for (auto link = route.link_list.rbegin(); link != route.link_list.rend(); ++link) {
+    auto known = hop_index_.find({*link, next});
+    if (known != hop_index_.end()) {
+      next = known->second;
+    } else {
+      hops_.push_back({*link, next});
+      xbt_assert(hops_.size() < std::numeric_limits<unsigned>::max(), "Too many links in the routes of this netzone");
+      next = hops_.size();
+      hop_index_.insert({{*link, hops_.back().next}, next});
+    }
+  }
+
+  RouteKey key{next, route.gw_src, route.gw_dst};
+  auto known = route_index_.find(key);
+  if (known != route_index_.end())
+    return known->second;
+  routes_.push_back({next, route.gw_src, route.gw_dst});
+  route_index_.insert({key, routes_.size() - 1});
+  return routes_.size() - 1;
+}
+
+void RouteStore::get_links(unsigned route, std::vector<resource::LinkImpl*>& links, double* latency) const
+{
+  for (unsigned hop = routes_[route].first; hop != 0; hop = hops_[hop - 1].next) {
+    resource::LinkImpl* link = hops_[hop - 1].link;
+    links.push_back(link);
+    if (latency)
+      *latency += link->get_latency();
+  }
+}
+
+unsigned RouteStore::get_size(unsigned route) const
+{
+  unsigned size = 0;
+  for (unsigned hop = routes_[route].first; hop != 0; hop = hops_[hop - 1].next)
+    size++;
+  return size;
+}
+
+void RouteStore::shrink()
+{
+  XBT_DEBUG("%zu distinct routes stored with %zu hops", routes_.size(), hops_.size());
+  std::unordered_map<HopKey, unsigned, KeyHash>().swap(hop_index_);
+  std::unordered_map<RouteKey, unsigned, KeyHash>().swap(route_index_);
+  hops_.shrink_to_fit();
+  routes_.shrink_to_fit();
+}
+}
+}
+}
+
 /* ***************************************************************** */
 /* *********************** GENERIC METHODS ************************* */
 
@@ -3,6 +3,7 @@
 /* This program is free software; you can redistribute it and/or modify it
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
@@ -18,6 +19,9 @@
 namespace simgrid {
 namespace mc {
 
+/** Maximal number of pages read at once when taking a snapshot */
+static constexpr std::size_t max_batch_pages = 256;
+
 /** Take a per-page snapshot of a region
  *
  *  @param addr            The start of the region (must be at the beginning of a page)
@@ -29,27 +33,17 @@ ChunkedData::ChunkedData(PageStore& store, AddressSpace& as,
 {
   store_ = &store;
   this->pagenos_.resize(page_count);
-  std::vector<char> buffer(xbt_pagesize);
-
-  for (size_t i = 0; i != page_count; ++i) {
-
-      RemotePtr<void> page = remote((void*)
-        simgrid::mc::mmu::join(i, addr.address()));
-      xbt_assert(simgrid::mc::mmu::split(page.address()).second == 0,
-        "Not at the beginning of a page");
-
-      /* Adding another copy (and a syscall) will probably slow things a lot.
-         TODO, optimize this somehow (at least by grouping the syscalls)
-         if needed. Either:
-         - reduce the number of syscalls
-         - let the application snapshot itself
-         - move the segments in shared memory (this will break `fork` however)
-      */
-
-      as.read_bytes(buffer.data(), xbt_pagesize, page, simgrid::mc::ProcessIndexDisabled);
-
-      pagenos_[i] = store_->store_page(buffer.data());
-
+  xbt_assert(simgrid::mc::mmu::split(addr.address()).second == 0, "Not at the beginning of a page");
+
+  /* The pages are read by batches, with one system call each, before being stored one by one */
+  std::size_t batch_pages = std::min(page_count, max_batch_pages);
+  std::vector<char> buffer(batch_pages * xbt_pagesize);
+  for (size_t i = 0; i < page_count; i += batch_pages) {
+    std::size_t n        = std::min(batch_pages, page_count - i);
+    RemotePtr<void> page = remote((void*)simgrid::mc::mmu::join(i, addr.address()));
+    as.read_bytes(buffer.data(), n * xbt_pagesize, page, simgrid::mc::ProcessIndexDisabled);
+    for (size_t j = 0; j < n; j++)
+      pagenos_[i + j] = store_->store_page(buffer.data() + j * xbt_pagesize);
   }
 }
 
@@ -26,6 +26,7 @@
 #include "src/mc/PageStore.hpp"
 #include "src/mc/Transition.hpp"
 #include "src/mc/checker/Checker.hpp"
+#include "src/mc/mc_config.hpp"
 #include "src/mc/mc_exit.hpp"
 #include "src/mc/mc_private.hpp"
 #include "src/mc/mc_record.hpp"
@@ -54,7 +55,7 @@ ModelChecker::ModelChecker(std::unique_ptr<RemoteClient> process)
     , process_(std::move(process))
     , parent_snapshot_(nullptr)
 {
-
+  page_store_.set_hot_limit(_sg_mc_hot_pages);
 }
 
 ModelChecker::~ModelChecker() {
@@ -102,9 +103,12 @@ void ModelChecker::start()
   setup_ignore();
 
 #ifdef __linux__
-  ptrace(PTRACE_SETOPTIONS, pid, nullptr, PTRACE_O_TRACEEXIT);
+  // With fork checkpoints, we trace the forks of the application, which are stopped as soon as they are created:
+  ptrace(PTRACE_SETOPTIONS, pid, nullptr, PTRACE_O_TRACEEXIT | (_sg_mc_fork_checkpoint ? PTRACE_O_TRACEFORK : 0));
   ptrace(PTRACE_CONT, pid, 0, 0);
 #elif defined BSD
+  if (_sg_mc_fork_checkpoint)
+    xbt_die("The fork checkpoints are only implemented on Linux");
   ptrace(PT_CONTINUE, pid, (caddr_t)1, 0);
 #else
 # error "no ptrace equivalent coded for this platform"
@@ -150,6 +154,9 @@ void ModelChecker::shutdown()
     kill(process->pid(), SIGKILL);
     process->terminate();
   }
+  for (pid_t checkpoint : checkpoints_)
+    kill(checkpoint, SIGKILL);
+  checkpoints_.clear();
 }
 
 void ModelChecker::resume(simgrid::mc::RemoteClient& process)
@@ -291,6 +298,8 @@ void ModelChecker::exit(int status)
   // TODO, terminate the model checker politely instead of exiting rudely
   if (process().running())
     kill(process().pid(), SIGKILL);
+  for (pid_t checkpoint : checkpoints_)
+    kill(checkpoint, SIGKILL);
   ::exit(status);
 }
 
@@ -357,7 +366,8 @@ void ModelChecker::handle_waitpid()
         XBT_DEBUG("Stopped with signal %i", (int) WSTOPSIG(status));
         errno = 0;
 #ifdef __linux__
-        ptrace(PTRACE_CONT, this->process().pid(), 0, WSTOPSIG(status));
+        // The SIGTRAP of the ptrace events is not a real signal:
+        ptrace(PTRACE_CONT, this->process().pid(), 0, (status >> 16) ? 0 : WSTOPSIG(status));
 #elif defined BSD
         ptrace(PT_CONTINUE, this->process().pid(), (caddr_t)1, WSTOPSIG(status));
 #endif
@@ -399,6 +409,107 @@ void ModelChecker::handle_simcall(Transition const& transition)
     event_base_dispatch(base_);
 }
 
+#ifdef __linux__
+/** Wait for the next event of a traced process */
+static int wait_traced(pid_t pid)
+{
+  int status;
+  while (waitpid(pid, &status, WAITPID_CHECKED_FLAGS) < 0)
+    if (errno != EINTR)
+      throw simgrid::xbt::errno_error();
+  return status;
+}
+
+/** Wait until a traced process forks, and until its fork is started (and stopped by ptrace) */
+static pid_t wait_fork(pid_t pid)
+{
+  int status = wait_traced(pid);
+  if (status >> 8 != (SIGTRAP | (PTRACE_EVENT_FORK << 8)))
+    xbt_die("Process %i stopped before forking (status %#x)", (int)pid, (unsigned)status);
+  unsigned long fork_pid;
+  if (ptrace(PTRACE_GETEVENTMSG, pid, 0, &fork_pid) == -1)
+    xbt_die("Could not get the pid of the fork of process %i", (int)pid);
+  status = wait_traced(fork_pid);
+  if (not WIFSTOPPED(status) || WSTOPSIG(status) != SIGSTOP)
+    xbt_die("Unexpected start of the fork %lu (status %#x)", fork_pid, (unsigned)status);
+  return fork_pid;
+}
+
+/** Kill a traced process, and wait for its end */
+static void kill_traced(pid_t pid)
+{
+  kill(pid, SIGKILL);
+  int status = wait_traced(pid);
+  while (WIFSTOPPED(status)) { // PTRACE_O_TRACEEXIT
+    ptrace(PTRACE_CONT, pid, 0, 0);
+    status = wait_traced(pid);
+  }
+}
+#endif
+
+/** Fork a frozen copy of the model-checked process, which can be restored later */
+pid_t ModelChecker::fork_checkpoint()
+{
+#ifdef __linux__
+  pid_t pid = process().pid();
+  if (process().getChannel().send(MC_MESSAGE_FORK))
+    xbt_die("Could not ask the model-checked process to fork");
+  pid_t checkpoint = wait_fork(pid);
+  ptrace(PTRACE_CONT, pid, 0, 0);
+  checkpoints_.insert(checkpoint);
+  XBT_DEBUG("Checkpoint %i forked from %i", (int)checkpoint, (int)pid);
+  return checkpoint;
+#else
+  xbt_die("The fork checkpoints are only implemented on Linux");
+#endif
+}
+
+/** Replace the model-checked process by a fork of the given checkpoint, which remains available */
+void ModelChecker::restore_checkpoint(pid_t checkpoint)
+{
+#ifdef __linux__
+  if (process().running())
+    kill_traced(process().pid());
+
+  // The checkpoint forks the new model-checked process, and stops again:
+  ptrace(PTRACE_CONT, checkpoint, 0, 0);
+  pid_t pid = wait_fork(checkpoint);
+  ptrace(PTRACE_CONT, checkpoint, 0, 0);
+  int status = wait_traced(checkpoint);
+  if (not WIFSTOPPED(status) || WSTOPSIG(status) != SIGSTOP)
+    xbt_die("Checkpoint %i did not stop after the restore (status %#x)", (int)checkpoint, (unsigned)status);
+
+  XBT_DEBUG("Process %i restored from checkpoint %i", (int)pid, (int)checkpoint);
+  process().reattach(pid);
+  ptrace(PTRACE_CONT, pid, 0, 0);
+#else
+  xbt_die("The fork checkpoints are only implemented on Linux");
+#endif
+}
+
+void ModelChecker::drop_checkpoint(pid_t checkpoint)
+{
+#ifdef __linux__
+  if (checkpoints_.erase(checkpoint))
+    kill_traced(checkpoint);
+#endif
+}
+
+ForkCheckpoint::ForkCheckpoint() : pid_(mc_model_checker->fork_checkpoint())
+{
+}
+
+ForkCheckpoint::~ForkCheckpoint()
+{
+  if (mc_model_checker)
+    mc_model_checker->drop_checkpoint(pid_);
+}
+
+void ForkCheckpoint::restore() const
+{
+  mc_model_checker->restore_checkpoint(pid_);
+}
+
 bool ModelChecker::checkDeadlock()
 {
   int res;
@@ -40,6 +40,7 @@ class ModelChecker {
   PageStore page_store_;
   std::unique_ptr<RemoteClient> process_;
   Checker* checker_ = nullptr;
+  std::set<pid_t> checkpoints_; /* frozen forks of the model-checked process */
 public:
   std::shared_ptr<simgrid::mc::Snapshot> parent_snapshot_;
 
@@ -72,6 +73,10 @@ public:
   void handle_simcall(Transition const& transition);
   void exit(int status);
 
+  pid_t fork_checkpoint();
+  void restore_checkpoint(pid_t checkpoint);
+  void drop_checkpoint(pid_t checkpoint);
+
   bool checkDeadlock();
 
   Checker* getChecker() const { return checker_; }
@@ -88,6 +93,23 @@ public:
   unsigned long executed_transitions = 0;
 };
 
+/** A checkpoint of the state of the model-checked process, kept as a frozen fork of it
+ *
+ *  Restoring the checkpoint replaces the model-checked process by a new fork of the frozen one: the kernel shares the
+ *  memory of the processes copy-on-write, so neither taking nor restoring the checkpoint copies the memory.
+ */
+class ForkCheckpoint {
+  pid_t pid_;
+
+public:
+  ForkCheckpoint();
+  ~ForkCheckpoint();
+  ForkCheckpoint(ForkCheckpoint const&) = delete;
+  ForkCheckpoint& operator=(ForkCheckpoint const&) = delete;
+
+  void restore() const;
+};
+
 }
 }
 
@@ -59,6 +59,9 @@ PageStore::PageStore(size_t size) : memory_(nullptr), capacity_(size), top_index
   this->top_index_ = 0;
   this->memory_ = memory;
   this->page_counts_.resize(size);
+  this->page_hashes_.resize(size);
+  this->cold_pages_.resize(size);
+  this->referenced_.resize(size);
 }
 
 PageStore::~PageStore()
@@ -114,6 +117,9 @@ void PageStore::resize(std::size_t size)
   this->capacity_ = size;
   this->memory_ = new_memory;
   this->page_counts_.resize(size, 0);
+  this->page_hashes_.resize(size, 0);
+  this->cold_pages_.resize(size);
+  this->referenced_.resize(size, false);
 }
 
 /** Allocate a free page
@@ -144,9 +150,97 @@ std::size_t PageStore::alloc_page()
 void PageStore::remove_page(std::size_t pageno)
 {
   this->free_pages_.push_back(pageno);
-  const void* page = this->get_page(pageno);
-  hash_type hash = mc_hash_page(page);
-  this->hash_index_[hash].erase(pageno);
+  this->hash_index_[page_hashes_[pageno]].erase(pageno);
+  if (not this->cold_pages_[pageno].empty()) {
+    // The content of the page is not needed anymore, and its place in the region is zero-filled:
+    this->cold_count_--;
+    this->cold_bytes_ -= this->cold_pages_[pageno].size() * sizeof(std::uint64_t);
+    std::vector<std::uint64_t>().swap(this->cold_pages_[pageno]);
+  }
+}
+
+/** Compress a page, and give its memory back to the system
+ *
+ *  The memory pages are mostly made of zeros: the compressed page is a bitmap of the non-zero words of the page,
+ *  followed by these words. The pages which cannot be compressed to less than 3/4 of their size are left alone.
+ *
+ *  @return whether the page was compressed
+ */
+bool PageStore::compress_page(std::size_t pageno)
+{
+  std::uint64_t* words     = (std::uint64_t*)simgrid::mc::mmu::join(pageno, (std::uintptr_t)memory_);
+  std::size_t word_count  = xbt_pagesize / sizeof(std::uint64_t);
+  std::size_t bitmap_size = (word_count + 63) / 64;
+
+  std::size_t nonzero = 0;
+  for (std::size_t i = 0; i != word_count; ++i)
+    nonzero += (words[i] != 0);
+  if (bitmap_size + nonzero > word_count / 4 * 3)
+    return false;
+
+  std::vector<std::uint64_t> compressed(bitmap_size + nonzero, 0);
+  std::size_t next = bitmap_size;
+  for (std::size_t i = 0; i != word_count; ++i)
+    if (words[i] != 0) {
+      compressed[i / 64] |= std::uint64_t(1) << (i % 64);
+      compressed[next++] = words[i];
+    }
+  madvise(words, xbt_pagesize, MADV_DONTNEED);
+
+  this->cold_bytes_ += compressed.size() * sizeof(std::uint64_t);
+  this->cold_count_++;
+  this->compressions_++;
+  this->cold_pages_[pageno] = std::move(compressed);
+  return true;
+}
+
+/** Uncompress a page in place */
+const void* PageStore::decompress_page(std::size_t pageno) const
+{
+  std::uint64_t* words                       = (std::uint64_t*)simgrid::mc::mmu::join(pageno, (std::uintptr_t)memory_);
+  std::vector<std::uint64_t> const& compressed = this->cold_pages_[pageno];
+  std::size_t word_count                     = xbt_pagesize / sizeof(std::uint64_t);
+  std::size_t next                           = (word_count + 63) / 64;
+  for (std::size_t i = 0; i != word_count; ++i)
+    words[i] = (compressed[i / 64] >> (i % 64)) & 1 ? compressed[next++] : 0;
+
+  this->cold_bytes_ -= compressed.size() * sizeof(std::uint64_t);
+  this->cold_count_--;
+  this->decompressions_++;
+  std::vector<std::uint64_t>().swap(this->cold_pages_[pageno]);
+  this->referenced_[pageno] = true;
+  return words;
+}
+
+void PageStore::compress_cold_pages()
+{
+  std::size_t hot = this->size() - this->cold_count_;
+  if (this->hot_limit_ == 0 || hot <= this->hot_limit_)
+    return;
+
+  // Go down to 3/4 of the limit, so that we do not have to sweep again at the next snapshot:
+  std::size_t target = this->hot_limit_ - this->hot_limit_ / 4;
+  for (std::size_t steps = 0; hot > target && steps < 2 * this->top_index_; steps++) {
+    std::size_t pageno = this->clock_hand_;
+    this->clock_hand_  = (this->clock_hand_ + 1) % this->top_index_;
+    if (this->page_counts_[pageno] == 0 || not this->cold_pages_[pageno].empty())
+      continue;
+    if (this->referenced_[pageno])
+      this->referenced_[pageno] = false;
+    else if (this->compress_page(pageno))
+      hot--;
+    else
+      this->referenced_[pageno] = true; // Do not try again at the next sweep
+  }
+  XBT_DEBUG("%zu pages compressed in %zu KiB, %zu uncompressed pages", this->cold_count_, this->cold_bytes_ / 1024,
+            hot);
+}
+
+void PageStore::log_statistics() const
+{
+  XBT_INFO("Page store: %zu pages, %zu of them compressed (%zu KiB saved); %lu compressions, %lu decompressions",
+           this->top_index_ - this->free_pages_.size(), this->cold_count_,
+           (this->cold_count_ * xbt_pagesize - this->cold_bytes_) / 1024, this->compressions_, this->decompressions_);
 }
 
 /** Store a page in memory */
@@ -168,6 +262,7 @@ std::size_t PageStore::store_page(void* page)
 
       // If a page with the same content is already in the page store it's reused and its refcount is incremented.
       page_counts_[pageno]++;
+      referenced_[pageno] = true;
       return pageno;
 
     }
@@ -180,6 +275,8 @@ std::size_t PageStore::store_page(void* page)
   memcpy(snapshot_page, page, xbt_pagesize);
   page_set.insert(pageno);
   page_counts_[pageno]++;
+  page_hashes_[pageno] = hash;
+  referenced_[pageno]  = true;
   return pageno;
 }
 
@@ -257,4 +354,45 @@ XBT_TEST_UNIT("base", test_mc_page_store, "Test adding/removing pages in the sto
   xbt_test_assert(store->size()==2, "Bad size");
 }
 
+XBT_TEST_UNIT("compression", test_mc_page_store_compression, "Test the compression of the unused pages")
+{
+  using simgrid::mc::PageStore;
+
+  xbt_test_add("Init");
+  std::size_t pagesize = (size_t) getpagesize();
+  std::unique_ptr<PageStore> store = std::unique_ptr<PageStore>(new simgrid::mc::PageStore(500));
+  store->set_hot_limit(4);
+  std::vector<void*> data;
+  std::vector<std::size_t> pagenos;
+  for (int i = 0; i < 8; i++) {
+    data.push_back(getpage());
+    ::memset(data.back(), 0, pagesize);
+    ::memset(data.back(), i + 1, 64); // mostly zeros: compressible
+    pagenos.push_back(store->store_page(data.back()));
+  }
+
+  xbt_test_add("Compress the unused pages");
+  store->compress_cold_pages();
+  xbt_test_assert(store->cold_size() == 5, "Bad number of compressed pages: %zu", store->cold_size());
+  xbt_test_assert(store->size() == 8, "Bad size");
+
+  xbt_test_add("Use the compressed pages");
+  for (int i = 0; i < 8; i++)
+    xbt_test_assert(::memcmp(data[i], store->get_page(pagenos[i]), pagesize) == 0, "Page %d data should be the same", i);
+  xbt_test_assert(store->cold_size() == 0, "The pages should be uncompressed");
+
+  xbt_test_add("Find a compressed page");
+  store->compress_cold_pages();
+  xbt_test_assert(store->cold_size() == 5, "The pages should be compressed again");
+  xbt_test_assert(store->store_page(data[0]) == pagenos[0], "The compressed page should be found");
+
+  xbt_test_add("Remove a compressed page");
+  store->compress_cold_pages();
+  for (std::size_t pageno : pagenos)
+    while (store->get_ref(pageno) > 0)
+      store->unref_page(pageno);
+  xbt_test_assert(store->cold_size() == 0, "The removed pages should be forgotten");
+  xbt_test_assert(store->size() == 0, "Bad size");
+}
+
 #endif /* SIMGRID_TEST */
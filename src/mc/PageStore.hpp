@@ -71,6 +71,14 @@ namespace mc {
  *    We use a fast (non cryptographic) hash so there may be conflicts:
  *    we must be able to store multiple indices for the same hash.
  *
+ *  * When the number of uncompressed pages is limited (`hot_limit_`), the
+ *    pages which are not used anymore are compressed (`cold_pages_`) by
+ *    `compress_cold_pages()`, and their memory is given back to the system.
+ *    The pages are chosen by a clock algorithm: the pages used since the
+ *    previous sweep (`referenced_`) are spared. A compressed page keeps its
+ *    place in the region, and is uncompressed there as soon as it is used
+ *    again: the compression is transparent to the users of the store.
+ *
  */
 class PageStore {
 public: // Types
@@ -93,15 +101,31 @@ private:
   std::size_t top_index_;
   /** Page reference count */
   std::vector<std::uint64_t> page_counts_;
+  /** Hash of the content of each used page */
+  std::vector<hash_type> page_hashes_;
   /** Index of available pages before the top */
   std::vector<std::size_t> free_pages_;
   /** Index from page hash to page index */
   pages_map_type hash_index_;
 
+  /** Maximal number of uncompressed pages (0 for no limit) */
+  std::size_t hot_limit_ = 0;
+  /** Compressed content of each page (empty if the page is not compressed) */
+  mutable std::vector<std::vector<std::uint64_t>> cold_pages_;
+  /** Whether each page was used since the clock passed on it */
+  mutable std::vector<bool> referenced_;
+  std::size_t clock_hand_ = 0;
+  mutable std::size_t cold_count_   = 0;
+  mutable std::size_t cold_bytes_   = 0;
+  unsigned long compressions_       = 0;
+  mutable unsigned long decompressions_ = 0;
+
   // Methods
   void resize(std::size_t size);
   std::size_t alloc_page();
   void remove_page(std::size_t pageno);
+  bool compress_page(std::size_t pageno);
+  const void* decompress_page(std::size_t pageno) const;
 
 public:
   // Constructors
@@ -137,6 +161,24 @@ public:
   /** @brief Store a page in the page store */
   std::size_t store_page(void* page);
 
+  /** @brief Limit the number of uncompressed pages
+   *
+   *  The limit is enforced by `compress_cold_pages()`. With the default value (0), the pages are never compressed.
+   */
+  void set_hot_limit(std::size_t pages) { hot_limit_ = pages; }
+
+  /** @brief Compress the pages that are not used anymore, if there are too many uncompressed pages
+   *
+   *  This invalidates the pointers returned by `get_page()`.
+   */
+  void compress_cold_pages();
+
+  /** @brief Log the statistics of the compression of the pages */
+  void log_statistics() const;
+
+  /** @brief Get the hash of the content of a page from its page number */
+  hash_type get_page_hash(std::size_t pageno) const { return page_hashes_[pageno]; }
+
   /** @brief Get a page from its page number
    *
    *  @param pageno Number of the memory page in the store
@@ -152,6 +194,9 @@ public:
   /** @brief Get the number of used pages */
   std::size_t size();
 
+  /** @brief Get the number of compressed pages */
+  std::size_t cold_size() const { return cold_count_; }
+
   /** @brief Get the capacity of the page store
    *
    *  The capacity is expanded by a system call (mremap).
@@ -169,10 +214,14 @@ XBT_ALWAYS_INLINE void PageStore::unref_page(std::size_t pageno)
 XBT_ALWAYS_INLINE void PageStore::ref_page(size_t pageno)
 {
   ++this->page_counts_[pageno];
+  this->referenced_[pageno] = true;
 }
 
 XBT_ALWAYS_INLINE const void* PageStore::get_page(std::size_t pageno) const
 {
+  if (not this->cold_pages_[pageno].empty())
+    return this->decompress_page(pageno);
+  this->referenced_[pageno] = true;
   return (void*) simgrid::mc::mmu::join(pageno, (std::uintptr_t) this->memory_);
 }
 
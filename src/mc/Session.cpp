@@ -100,11 +100,22 @@ Session::~Session()
   this->close();
 }
 
-void Session::initialize()
+/** Take the initial state of the exploration
+ *
+ *  The checkpoints can only be forks of the application for the checkers that never compare nor copy them: the
+ *  other checkers always use snapshots.
+ */
+void Session::initialize(bool fork_checkpoints)
 {
-  xbt_assert(initialSnapshot_ == nullptr);
+  xbt_assert(initialSnapshot_ == nullptr && initialCheckpoint_ == nullptr);
   mc_model_checker->wait_for_requests();
-  initialSnapshot_ = simgrid::mc::take_snapshot(0);
+  if (_sg_mc_fork_checkpoint && not fork_checkpoints)
+    XBT_WARN("model-check/fork-checkpoint is ignored: this checker needs snapshots of the application");
+  forkCheckpoints_ = fork_checkpoints;
+  if (forkCheckpoints_)
+    initialCheckpoint_ = std::unique_ptr<ForkCheckpoint>(new ForkCheckpoint());
+  else
+    initialSnapshot_ = simgrid::mc::take_snapshot(0);
 }
 
 void Session::execute(Transition const& transition)
@@ -115,12 +126,17 @@ void Session::execute(Transition const& transition)
 
 void Session::restoreInitialState()
 {
-  simgrid::mc::restore_snapshot(this->initialSnapshot_);
+  if (this->initialCheckpoint_)
+    this->initialCheckpoint_->restore();
+  else
+    simgrid::mc::restore_snapshot(this->initialSnapshot_);
 }
 
 void Session::logState()
 {
   mc_model_checker->getChecker()->logState();
+  if (_sg_mc_hot_pages > 0)
+    mc_model_checker->page_store().log_statistics();
 
   if (not _sg_mc_dot_output_file.get().empty()) {
     fprintf(dot_output, "}\n");
@@ -175,7 +191,8 @@ Session* Session::spawnvp(const char *file, char *const argv[])
 
 void Session::close()
 {
-  initialSnapshot_ = nullptr;
+  initialSnapshot_   = nullptr;
+  initialCheckpoint_ = nullptr;
   if (modelChecker_) {
     modelChecker_->shutdown();
     modelChecker_ = nullptr;
@@ -38,6 +38,8 @@ class Session {
 private:
   std::unique_ptr<ModelChecker> modelChecker_;
   std::shared_ptr<simgrid::mc::Snapshot> initialSnapshot_;
+  std::unique_ptr<ForkCheckpoint> initialCheckpoint_;
+  bool forkCheckpoints_ = false;
 
   Session(pid_t pid, int socket);
 
@@ -49,7 +51,9 @@ public:
   ~Session();
   void close();
 
-  void initialize();
+  void initialize(bool fork_checkpoints = false);
+  /** Whether the checkpoints of this session are forks of the application instead of snapshots */
+  bool forkCheckpoints() const { return forkCheckpoints_; }
   void execute(Transition const& transition);
   void logState();
 
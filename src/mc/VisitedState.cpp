@@ -8,8 +8,6 @@
 
 #include <memory>
 
-#include <boost/range/algorithm.hpp>
-
 #include "xbt/log.h"
 #include "xbt/sysdep.h"
 
@@ -33,6 +31,18 @@ static int snapshot_compare(simgrid::mc::VisitedState* state1, simgrid::mc::Visi
   return snapshot_compare(num1, s1, num2, s2);
 }
 
+/** @brief Whether two states with the same fingerprint are equal */
+static bool same_state(simgrid::mc::VisitedState* state1, simgrid::mc::VisitedState* state2)
+{
+  if (state1->actors_count != state2->actors_count || state1->heap_bytes_used != state2->heap_bytes_used)
+    return false;
+  if (same_memory(*state1->system_state, *state2->system_state)) {
+    XBT_DEBUG("States %d and %d have the same memory", state1->num, state2->num);
+    return true;
+  }
+  return snapshot_compare(state1, state2) == 0;
+}
+
 /** @brief Save the current state */
 VisitedState::VisitedState(unsigned long state_number) : num(state_number)
 {
@@ -49,15 +59,22 @@ VisitedState::VisitedState(unsigned long state_number) : num(state_number)
 
 void VisitedStates::prune()
 {
-  while (states_.size() > (std::size_t)_sg_mc_max_visited_states) {
+  while (count_ > (std::size_t)_sg_mc_max_visited_states) {
     XBT_DEBUG("Try to remove visited state (maximum number of stored states reached)");
-    auto min_element = boost::range::min_element(states_,
-      [](std::unique_ptr<simgrid::mc::VisitedState>& a, std::unique_ptr<simgrid::mc::VisitedState>& b) {
-        return a->num < b->num;
-      });
-    xbt_assert(min_element != states_.end());
+    auto min_bucket = states_.end();
+    std::vector<std::unique_ptr<simgrid::mc::VisitedState>>::iterator min_element;
+    for (auto bucket = states_.begin(); bucket != states_.end(); ++bucket)
+      for (auto it = bucket->second.begin(); it != bucket->second.end(); ++it)
+        if (min_bucket == states_.end() || (*it)->num < (*min_element)->num) {
+          min_bucket  = bucket;
+          min_element = it;
+        }
+    xbt_assert(min_bucket != states_.end());
     // and drop it:
-    states_.erase(min_element);
+    min_bucket->second.erase(min_element);
+    if (min_bucket->second.empty())
+      states_.erase(min_bucket);
+    count_--;
     XBT_DEBUG("Remove visited state (maximum number of stored states reached)");
   }
 }
@@ -73,13 +90,12 @@ std::unique_ptr<simgrid::mc::VisitedState> VisitedStates::addVisitedState(
   XBT_DEBUG("Snapshot %p of visited state %d (exploration stack state %d)",
     new_state->system_state.get(), new_state->num, graph_state->num);
 
-  auto range =
-      boost::range::equal_range(states_, new_state.get(), simgrid::mc::DerefAndCompareByActorsCountAndUsedHeap());
+  /* Only the states with the same fingerprint can be equal */
+  std::vector<std::unique_ptr<simgrid::mc::VisitedState>>& candidates = states_[new_state->system_state->hash];
 
   if (compare_snpashots)
-    for (auto i = range.first; i != range.second; ++i) {
-      auto& visited_state = *i;
-      if (snapshot_compare(visited_state.get(), new_state.get()) == 0) {
+    for (auto& visited_state : candidates) {
+      if (same_state(visited_state.get(), new_state.get())) {
         // The state has been visited:
 
         std::unique_ptr<simgrid::mc::VisitedState> old_state =
@@ -108,8 +124,9 @@ std::unique_ptr<simgrid::mc::VisitedState> VisitedStates::addVisitedState(
       }
     }
 
-  XBT_DEBUG("Insert new visited state %d (total : %lu)", new_state->num, (unsigned long) states_.size());
-  states_.insert(range.first, std::move(new_state));
+  XBT_DEBUG("Insert new visited state %d (total : %lu)", new_state->num, (unsigned long)count_);
+  candidates.insert(candidates.begin(), std::move(new_state));
+  count_++;
   this->prune();
   return nullptr;
 }
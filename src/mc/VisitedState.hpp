@@ -10,7 +10,10 @@
 #include <cstddef>
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
+#include "src/mc/mc_hash.hpp"
 #include "src/mc/mc_snapshot.hpp"
 #include "src/mc/mc_state.hpp"
 
@@ -30,9 +33,16 @@ public:
 };
 
 class XBT_PRIVATE VisitedStates {
-  std::vector<std::unique_ptr<simgrid::mc::VisitedState>> states_;
+  /* The visited states, by fingerprint of their snapshot */
+  std::unordered_map<hash_type, std::vector<std::unique_ptr<simgrid::mc::VisitedState>>> states_;
+  std::size_t count_ = 0;
+
 public:
-  void clear() { states_.clear(); }
+  void clear()
+  {
+    states_.clear();
+    count_ = 0;
+  }
   std::unique_ptr<simgrid::mc::VisitedState> addVisitedState(unsigned long state_number, simgrid::mc::State* graph_state, bool compare_snpashots);
 private:
   void prune();
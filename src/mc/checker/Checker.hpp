@@ -67,6 +67,14 @@ protected:
 XBT_PUBLIC Checker* createLivenessChecker(Session& session);
 XBT_PUBLIC Checker* createSafetyChecker(Session& session);
 XBT_PUBLIC Checker* createCommunicationDeterminismChecker(Session& session);
+
+/** Explore the state space with several worker processes, each one running its own session of the safety checker
+ *
+ *  @param workers number of worker processes
+ *  @param session code of the workers, creating the session and running the checker (returns the exit code)
+ *  @return exit code of the first worker reporting a problem, or success
+ */
+XBT_PUBLIC int runParallelSafetyChecker(int workers, std::function<int()> session);
 }
 }
 
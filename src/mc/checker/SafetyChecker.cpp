@@ -3,15 +3,27 @@
 /* This program is free software; you can redistribute it and/or modify it
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <csignal>
 #include <cstdio>
+#include <cstdlib>
 
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
 #include <xbt/log.h>
 #include <xbt/sysdep.h>
+#include <xbt/system_error.hpp>
 
 #include "src/mc/Session.hpp"
 #include "src/mc/Transition.hpp"
@@ -30,6 +42,20 @@ XBT_LOG_NEW_DEFAULT_SUBCATEGORY(mc_safety, mc,
 namespace simgrid {
 namespace mc {
 
+/** State shared by the workers of a parallel exploration (in a shared memory mapping) */
+struct ParallelExploration {
+  std::atomic<unsigned long> next_subtree;
+  /* Statistics of the subtrees, summed over the workers */
+  std::atomic<unsigned long> expanded_states;
+  std::atomic<unsigned long> visited_states;
+  std::atomic<unsigned long> executed_transitions;
+  /* Statistics of the top of the tree, which is explored by every worker */
+  std::atomic<unsigned long> top_expanded_states;
+  std::atomic<unsigned long> top_visited_states;
+  std::atomic<unsigned long> top_executed_transitions;
+};
+static ParallelExploration* parallel_exploration = nullptr;
+
 static int snapshot_compare(simgrid::mc::State* state1, simgrid::mc::State* state2)
 {
   simgrid::mc::Snapshot* s1 = state1->system_state.get();
@@ -77,6 +103,30 @@ std::vector<std::string> SafetyChecker::getTextualTrace() // override
   return trace;
 }
 
+/** Whether this worker explores the subtree of the state reached at the split depth, in a parallel exploration
+ *
+ *  The exploration above the split depth is the same in all the workers, so they meet the subtrees in the same order.
+ *  A worker reaching a subtree after the last one it claimed takes the next ticket from the shared counter: it explores
+ *  the subtree of this ticket, and skips the ones claimed by the other workers until then.
+ */
+bool SafetyChecker::claimSubtree()
+{
+  subtreeCount_++;
+  if (subtreeTicket_ < subtreeCount_)
+    subtreeTicket_ = ++parallel_exploration->next_subtree;
+  return subtreeTicket_ == subtreeCount_;
+}
+
+/** Whether the state at this depth of the stack is above the split depth, in a parallel exploration
+ *
+ *  These states are explored by every worker (with all their enabled actors in their interleave set, so that the
+ *  workers do not depend on the DPOR dependencies found in the subtrees of the others), and they are counted once.
+ */
+bool SafetyChecker::aboveSplitDepth(std::size_t depth) const
+{
+  return parallel_exploration != nullptr && depth < (std::size_t)_sg_mc_split_depth;
+}
+
 void SafetyChecker::logState() // override
 {
   XBT_INFO("Expanded states = %lu", expandedStatesCount_);
@@ -100,6 +150,8 @@ void SafetyChecker::run()
               state->interleaveSize());
 
     mc_model_checker->visited_states++;
+    if (aboveSplitDepth(stack_.size()))
+      topVisitedStates_++;
 
     // Backtrack if we reached the maximum depth
     if (stack_.size() > (std::size_t)_sg_mc_max_depth) {
@@ -140,7 +192,12 @@ void SafetyChecker::run()
     if (dot_output != nullptr)
       req_str = simgrid::mc::request_get_dot_output(req, state->transition.argument);
 
+    /* In a parallel exploration, the states down to the split depth are met by all the workers */
+    bool split = parallel_exploration != nullptr && stack_.size() + 1 <= (std::size_t)_sg_mc_split_depth;
+
     mc_model_checker->executed_transitions++;
+    if (split)
+      topExecutedTransitions_++;
 
     /* Actually answer the request: let execute the selected request (MCed does one step) */
     this->getSession().execute(state->transition);
@@ -148,14 +205,25 @@ void SafetyChecker::run()
     /* Create the new expanded state (copy the state of MCed into our MCer data) */
     std::unique_ptr<simgrid::mc::State> next_state =
         std::unique_ptr<simgrid::mc::State>(new simgrid::mc::State(++expandedStatesCount_));
+    if (split)
+      topExpandedStates_++;
 
     if (_sg_mc_termination)
       this->checkNonTermination(next_state.get());
 
-    /* Check whether we already explored next_state in the past (but only if interested in state-equality reduction) */
-    if (_sg_mc_max_visited_states > 0)
+    /* Check whether we already explored next_state in the past (but only if interested in state-equality reduction).
+     * In a parallel exploration, the states down to the split depth are not reduced, so that all the workers meet the
+     * same subtrees. */
+    if (_sg_mc_max_visited_states > 0 && not split)
       visitedState_ = visitedStates_.addVisitedState(expandedStatesCount_, next_state.get(), true);
 
+    if (split && stack_.size() + 1 == (std::size_t)_sg_mc_split_depth && not this->claimSubtree()) {
+      XBT_DEBUG("Subtree %lu is explored by another worker", subtreeCount_);
+      stack_.push_back(std::move(next_state));
+      this->backtrack(false);
+      continue;
+    }
+
     /* If this is a new state (or if we don't care about state-equality reduction) */
     if (visitedState_ == nullptr) {
 
@@ -164,7 +232,7 @@ void SafetyChecker::run()
         auto actor = remoteActor.copy.getBuffer();
         if (simgrid::mc::actor_is_enabled(actor)) {
           next_state->addInterleavingSet(actor);
-          if (reductionMode_ == simgrid::mc::ReductionMode::dpor)
+          if (reductionMode_ == simgrid::mc::ReductionMode::dpor && not aboveSplitDepth(stack_.size() + 1))
             break; // With DPOR, we take the first enabled transition
         }
       }
@@ -181,16 +249,27 @@ void SafetyChecker::run()
     stack_.push_back(std::move(next_state));
   }
 
+  if (parallel_exploration != nullptr) {
+    /* The statistics of all the workers are displayed at the end of the exploration. The top of the tree is the same
+     * in all the workers, whichever stores it. */
+    parallel_exploration->expanded_states += expandedStatesCount_ - topExpandedStates_;
+    parallel_exploration->visited_states += mc_model_checker->visited_states - topVisitedStates_;
+    parallel_exploration->executed_transitions += mc_model_checker->executed_transitions - topExecutedTransitions_;
+    parallel_exploration->top_expanded_states.store(topExpandedStates_);
+    parallel_exploration->top_visited_states.store(topVisitedStates_);
+    parallel_exploration->top_executed_transitions.store(topExecutedTransitions_);
+    return;
+  }
   XBT_INFO("No property violation found.");
   simgrid::mc::session->logState();
 }
 
-void SafetyChecker::backtrack()
+void SafetyChecker::backtrack(bool check_deadlock)
 {
   stack_.pop_back();
 
   /* Check for deadlocks */
-  if (mc_model_checker->checkDeadlock()) {
+  if (check_deadlock && mc_model_checker->checkDeadlock()) {
     MC_show_deadlock();
     throw simgrid::mc::DeadlockError();
   }
@@ -211,7 +290,8 @@ void SafetyChecker::backtrack()
         xbt_die("Mutex is currently not supported with DPOR,  use --cfg=model-check/reduction:none");
 
       const smx_actor_t issuer = MC_smx_simcall_get_issuer(req);
-      for (auto i = stack_.rbegin(); i != stack_.rend(); ++i) {
+      std::size_t depth = stack_.size();
+      for (auto i = stack_.rbegin(); i != stack_.rend(); ++i, --depth) {
         simgrid::mc::State* prev_state = i->get();
         if (simgrid::mc::request_depend(req, &prev_state->internal_req)) {
           if (XBT_LOG_ISENABLED(mc_safety, xbt_log_priority_debug)) {
@@ -230,7 +310,9 @@ void SafetyChecker::backtrack()
               state->num);
           }
 
-          if (not prev_state->actorStates[issuer->pid].isDone())
+          if (aboveSplitDepth(depth))
+            XBT_DEBUG("State %d already interleaves all the processes", prev_state->num);
+          else if (not prev_state->actorStates[issuer->pid].isDone())
             prev_state->addInterleavingSet(issuer);
           else
             XBT_DEBUG("Process %p is in done set", req->issuer);
@@ -273,6 +355,10 @@ void SafetyChecker::restoreState()
 {
   /* Intermediate backtracking */
   simgrid::mc::State* state = stack_.back().get();
+  if (state->checkpoint) {
+    state->checkpoint->restore();
+    return;
+  }
   if (state->system_state) {
     simgrid::mc::restore_snapshot(state->system_state);
     return;
@@ -282,6 +368,7 @@ void SafetyChecker::restoreState()
   simgrid::mc::session->restoreInitialState();
 
   /* Traverse the stack from the state at position start and re-execute the transitions */
+  bool top = aboveSplitDepth(stack_.size());
   for (std::unique_ptr<simgrid::mc::State> const& state : stack_) {
     if (state == stack_.back())
       break;
@@ -289,6 +376,10 @@ void SafetyChecker::restoreState()
     /* Update statistics */
     mc_model_checker->visited_states++;
     mc_model_checker->executed_transitions++;
+    if (top) {
+      topVisitedStates_++;
+      topExecutedTransitions_++;
+    }
   }
 }
 
@@ -306,12 +397,14 @@ SafetyChecker::SafetyChecker(Session& session) : Checker(session)
     XBT_INFO("Check a safety property. Reduction is: %s.",
         (reductionMode_ == simgrid::mc::ReductionMode::none ? "none":
             (reductionMode_ == simgrid::mc::ReductionMode::dpor ? "dpor": "unknown")));
-  simgrid::mc::session->initialize();
+  simgrid::mc::session->initialize(_sg_mc_fork_checkpoint);
 
   XBT_DEBUG("Starting the safety algorithm");
 
   std::unique_ptr<simgrid::mc::State> initial_state =
       std::unique_ptr<simgrid::mc::State>(new simgrid::mc::State(++expandedStatesCount_));
+  if (parallel_exploration != nullptr)
+    topExpandedStates_++;
 
   XBT_DEBUG("**************************************************");
   XBT_DEBUG("Initial state");
@@ -320,7 +413,7 @@ SafetyChecker::SafetyChecker(Session& session) : Checker(session)
   for (auto& actor : mc_model_checker->process().actors())
     if (simgrid::mc::actor_is_enabled(actor.copy.getBuffer())) {
       initial_state->addInterleavingSet(actor.copy.getBuffer());
-      if (reductionMode_ != simgrid::mc::ReductionMode::none)
+      if (reductionMode_ != simgrid::mc::ReductionMode::none && not aboveSplitDepth(1))
         break;
     }
 
@@ -332,5 +425,66 @@ Checker* createSafetyChecker(Session& session)
   return new SafetyChecker(session);
 }
 
+int runParallelSafetyChecker(int workers, std::function<int()> session)
+{
+  void* memory = mmap(nullptr, sizeof(ParallelExploration), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    throw simgrid::xbt::errno_error("Could not map the memory shared by the workers");
+  parallel_exploration = new (memory) ParallelExploration();
+  XBT_INFO("Exploring with %d workers, sharing out the subtrees at depth %d", workers, _sg_mc_split_depth.get());
+
+  std::vector<pid_t> pids;
+  for (int i = 0; i < workers; i++) {
+    pid_t pid = fork();
+    if (pid < 0)
+      throw simgrid::xbt::errno_error("Could not fork a worker");
+    if (pid == 0) {
+#ifdef __linux__
+      // Do not outlive the other workers:
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+      int res;
+      try {
+        res = session();
+      } catch (std::exception& e) {
+        XBT_ERROR("Exception: %s", e.what());
+        res = SIMGRID_MC_EXIT_ERROR;
+      }
+      std::exit(res);
+    }
+    pids.push_back(pid);
+  }
+
+  int res = SIMGRID_MC_EXIT_SUCCESS;
+  for (std::size_t running = pids.size(); running > 0; running--) {
+    int status;
+    pid_t pid;
+    while ((pid = wait(&status)) < 0)
+      if (errno != EINTR)
+        throw simgrid::xbt::errno_error("Could not wait for the workers");
+    int worker_res = WIFEXITED(status) ? WEXITSTATUS(status) : SIMGRID_MC_EXIT_ERROR;
+    if (worker_res != SIMGRID_MC_EXIT_SUCCESS && res == SIMGRID_MC_EXIT_SUCCESS) {
+      // This worker reported the problem, stop the other ones:
+      res = worker_res;
+      for (pid_t other : pids)
+        if (other != pid)
+          kill(other, SIGKILL);
+    }
+  }
+
+  if (res == SIMGRID_MC_EXIT_SUCCESS) {
+    XBT_INFO("No property violation found.");
+    XBT_INFO("Expanded states = %lu",
+             parallel_exploration->expanded_states.load() + parallel_exploration->top_expanded_states.load());
+    XBT_INFO("Visited states = %lu",
+             parallel_exploration->visited_states.load() + parallel_exploration->top_visited_states.load());
+    XBT_INFO("Executed transitions = %lu", parallel_exploration->executed_transitions.load() +
+                                               parallel_exploration->top_executed_transitions.load());
+  }
+  munmap(memory, sizeof(ParallelExploration));
+  parallel_exploration = nullptr;
+  return res;
+}
+
 }
 }
@@ -31,7 +31,9 @@ public:
   void logState() override;
 private:
   void checkNonTermination(simgrid::mc::State* current_state);
-  void backtrack();
+  bool claimSubtree();
+  bool aboveSplitDepth(std::size_t depth) const;
+  void backtrack(bool check_deadlock = true);
   void restoreState();
 
   /** Stack representing the position in the exploration graph */
@@ -39,6 +41,14 @@ private:
   simgrid::mc::VisitedStates visitedStates_;
   std::unique_ptr<simgrid::mc::VisitedState> visitedState_;
   unsigned long expandedStatesCount_ = 0;
+
+  /** Number of subtrees met at the split depth, and last one claimed by this worker (in a parallel exploration) */
+  unsigned long subtreeCount_ = 0;
+  unsigned long subtreeTicket_ = 0;
+  /** Statistics of the states above the split depth, which all the workers explore (in a parallel exploration) */
+  unsigned long topExpandedStates_      = 0;
+  unsigned long topVisitedStates_       = 0;
+  unsigned long topExecutedTransitions_ = 0;
 };
 
 }
@@ -49,10 +49,32 @@ static std::unique_ptr<simgrid::mc::Checker> createChecker(simgrid::mc::Session&
     return std::unique_ptr<simgrid::mc::Checker>(simgrid::mc::createLivenessChecker(session));
 }
 
-int main(int argc, char** argv)
+/** Model-check the application given on the command line */
+static int run_session(char** argv)
 {
   using simgrid::mc::Session;
 
+  std::unique_ptr<Session> session = std::unique_ptr<Session>(Session::spawnvp(argv[1], argv + 1));
+
+  simgrid::mc::session = session.get();
+  std::unique_ptr<simgrid::mc::Checker> checker = createChecker(*session);
+  int res = SIMGRID_MC_EXIT_SUCCESS;
+  try {
+    checker->run();
+  } catch (simgrid::mc::DeadlockError& de) {
+    res = SIMGRID_MC_EXIT_DEADLOCK;
+  } catch (simgrid::mc::TerminationError& te) {
+    res = SIMGRID_MC_EXIT_NON_TERMINATION;
+  } catch (simgrid::mc::LivenessError& le) {
+    res = SIMGRID_MC_EXIT_LIVENESS;
+  }
+  checker = nullptr;
+  session->close();
+  return res;
+}
+
+int main(int argc, char** argv)
+{
   try {
     if (argc < 2)
       xbt_die("Missing arguments.\n");
@@ -67,24 +89,16 @@ int main(int argc, char** argv)
     xbt_log_init(&argc, argv);
     sg_config_init(&argc, argv);
 
-    std::unique_ptr<Session> session =
-      std::unique_ptr<Session>(Session::spawnvp(argv_copy[1], argv_copy+1));
-    delete[] argv_copy;
-
-    simgrid::mc::session = session.get();
-    std::unique_ptr<simgrid::mc::Checker> checker = createChecker(*session);
-    int res = SIMGRID_MC_EXIT_SUCCESS;
-    try {
-      checker->run();
-    } catch (simgrid::mc::DeadlockError& de) {
-      res = SIMGRID_MC_EXIT_DEADLOCK;
-    } catch (simgrid::mc::TerminationError& te) {
-      res = SIMGRID_MC_EXIT_NON_TERMINATION;
-    } catch (simgrid::mc::LivenessError& le) {
-      res = SIMGRID_MC_EXIT_LIVENESS;
+    int res;
+    if (_sg_mc_workers > 1 && not _sg_mc_comms_determinism && not _sg_mc_send_determinism &&
+        _sg_mc_property_file.get().empty()) {
+      res = simgrid::mc::runParallelSafetyChecker(_sg_mc_workers, [argv_copy]() { return run_session(argv_copy); });
+    } else {
+      if (_sg_mc_workers > 1)
+        XBT_WARN("Only the safety checks can be run by several workers. Exploring sequentially.");
+      res = run_session(argv_copy);
     }
-    checker = nullptr;
-    session->close();
+    delete[] argv_copy;
     return res;
   }
   catch(std::exception& e) {
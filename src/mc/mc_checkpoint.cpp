@@ -400,16 +400,20 @@ static std::vector<s_mc_stack_frame_t> unwind_stack_frames(simgrid::mc::UnwindCo
 static std::vector<s_mc_snapshot_stack_t> take_snapshot_stacks(simgrid::mc::Snapshot* snapshot)
 {
   std::vector<s_mc_snapshot_stack_t> res;
+  std::vector<s_stack_region_t> const& stack_areas = mc_model_checker->process().stack_areas();
 
-  for (auto const& stack : mc_model_checker->process().stack_areas()) {
-    s_mc_snapshot_stack_t st;
+  // Read the contexts from remote process, all at once:
+  std::vector<unw_context_t> contexts(stack_areas.size());
+  std::vector<simgrid::mc::RemoteRead> reads;
+  for (std::size_t i = 0; i < stack_areas.size(); i++)
+    reads.push_back({&contexts[i], sizeof(unw_context_t), remote(stack_areas[i].context)});
+  mc_model_checker->process().read_batch(reads);
 
-    // Read the context from remote process:
-    unw_context_t context;
-    mc_model_checker->process().read_bytes(
-      &context, sizeof(context), remote(stack.context));
+  for (std::size_t i = 0; i < stack_areas.size(); i++) {
+    s_stack_region_t const& stack = stack_areas[i];
+    s_mc_snapshot_stack_t st;
 
-    st.context.initialize(&mc_model_checker->process(), &context);
+    st.context.initialize(&mc_model_checker->process(), &contexts[i]);
 
     st.stack_frames = unwind_stack_frames(&st.context);
     st.local_variables = get_local_variables_values(st.stack_frames, stack.process_index);
@@ -432,17 +436,18 @@ static void snapshot_handle_ignore(simgrid::mc::Snapshot* snapshot)
 {
   xbt_assert(snapshot->process());
 
-  // Copy the memory:
+  // Copy the memory, all the regions at once:
+  std::vector<simgrid::mc::RemoteRead> reads;
   for (auto const& region : mc_model_checker->process().ignored_regions()) {
     s_mc_snapshot_ignored_data_t ignored_data;
     ignored_data.start = (void*)region.addr;
     ignored_data.data.resize(region.size);
-    // TODO, we should do this once per privatization segment:
-    snapshot->process()->read_bytes(
-      ignored_data.data.data(), region.size, remote(region.addr),
-      simgrid::mc::ProcessIndexDisabled);
     snapshot->ignored_data.push_back(std::move(ignored_data));
   }
+  for (s_mc_snapshot_ignored_data_t& ignored_data : snapshot->ignored_data)
+    // TODO, we should do this once per privatization segment:
+    reads.push_back({ignored_data.data.data(), ignored_data.data.size(), remote(ignored_data.start)});
+  snapshot->process()->read_batch(reads);
 
   // Zero the memory:
   for (auto const& region : mc_model_checker->process().ignored_regions())
@@ -547,6 +552,7 @@ std::shared_ptr<simgrid::mc::Snapshot> take_snapshot(int num_state)
   simgrid::mc::RemoteClient* mc_process = &mc_model_checker->process();
 
   std::shared_ptr<simgrid::mc::Snapshot> snapshot = std::make_shared<simgrid::mc::Snapshot>(mc_process, num_state);
+  simgrid::mc::RemoteReadStats read_stats = mc_process->read_stats();
 
   for (auto const& p : mc_model_checker->process().actors())
     snapshot->enabled_processes.insert(p.copy.getBuffer()->pid);
@@ -562,15 +568,22 @@ std::shared_ptr<simgrid::mc::Snapshot> take_snapshot(int num_state)
   snapshot->to_ignore = mc_model_checker->process().ignored_heap();
 
   if (_sg_mc_max_visited_states > 0 || not _sg_mc_property_file.get().empty()) {
-    snapshot->stacks = take_snapshot_stacks(snapshot.get());
-    if (_sg_mc_hash)
-      snapshot->hash = simgrid::mc::hash(*snapshot);
-    else
-      snapshot->hash = 0;
-  } else
-    snapshot->hash = 0;
+    snapshot->stacks       = take_snapshot_stacks(snapshot.get());
+    snapshot->hash         = simgrid::mc::hash(*snapshot);
+    snapshot->content_hash = simgrid::mc::content_hash(*snapshot);
+  } else {
+    snapshot->hash         = 0;
+    snapshot->content_hash = 0;
+  }
 
   snapshot_ignore_restore(snapshot.get());
+
+  /* The snapshot is complete: compress the pages that the recent snapshots do not use */
+  if (_sg_mc_sparse_checkpoint)
+    mc_model_checker->page_store().compress_cold_pages();
+
+  XBT_DEBUG("Snapshot %i: %llu bytes read from the process with %lu system calls", num_state,
+            mc_process->read_stats().bytes - read_stats.bytes, mc_process->read_stats().syscalls - read_stats.syscalls);
   return snapshot;
 }
 
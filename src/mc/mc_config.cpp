@@ -66,6 +66,19 @@ simgrid::config::Flag<int> _sg_mc_checkpoint{
 simgrid::config::Flag<bool> _sg_mc_sparse_checkpoint{"model-check/sparse-checkpoint", "Use sparse per-page snapshots.",
                                                      false, [](bool) { _mc_cfg_cb_check("checkpointing value"); }};
 
+simgrid::config::Flag<int> _sg_mc_hot_pages{
+    "model-check/hot-pages", "Maximal number of uncompressed pages in the store of the sparse snapshots "
+                             "(default: 0 => the pages are never compressed)",
+    0, [](int value) {
+      _mc_cfg_cb_check("number of uncompressed pages");
+      if (value < 0)
+        xbt_die("model-check/hot-pages cannot be negative");
+    }};
+
+simgrid::config::Flag<bool> _sg_mc_fork_checkpoint{
+    "model-check/fork-checkpoint", "Keep the checkpoints as frozen forks of the application instead of snapshots", false,
+    [](bool) { _mc_cfg_cb_check("checkpointing value"); }};
+
 simgrid::config::Flag<bool> _sg_mc_ksm{"model-check/ksm", "Kernel same-page merging", false,
                                        [](bool) { _mc_cfg_cb_check("KSM value"); }};
 
@@ -129,6 +142,22 @@ static simgrid::config::Flag<int> _sg_mc_max_visited_states__{
       _sg_mc_max_visited_states = value;
     }};
 
+simgrid::config::Flag<int> _sg_mc_workers{
+    "model-check/workers", "Number of worker processes sharing the exploration of the safety checker (default: 1)", 1,
+    [](int value) {
+      _mc_cfg_cb_check("number of workers");
+      if (value < 1)
+        xbt_die("model-check/workers must be positive");
+    }};
+
+simgrid::config::Flag<int> _sg_mc_split_depth{
+    "model-check/split-depth", "Depth at which the workers share out the subtrees of the exploration (default: 4)", 4,
+    [](int value) {
+      _mc_cfg_cb_check("split depth");
+      if (value < 2)
+        xbt_die("model-check/split-depth must be at least 2, since the subtrees start after the initial state");
+    }};
+
 simgrid::config::Flag<std::string> _sg_mc_dot_output_file{
     "model-check/dot-output",
     {"model-check/dot_output"},
@@ -14,6 +14,8 @@ extern XBT_PUBLIC simgrid::config::Flag<std::string> _sg_mc_record_path;
 extern XBT_PRIVATE simgrid::config::Flag<bool> _sg_do_model_check_record;
 extern XBT_PRIVATE simgrid::config::Flag<int> _sg_mc_checkpoint;
 extern XBT_PUBLIC simgrid::config::Flag<bool> _sg_mc_sparse_checkpoint;
+extern XBT_PRIVATE simgrid::config::Flag<int> _sg_mc_hot_pages;
+extern XBT_PRIVATE simgrid::config::Flag<bool> _sg_mc_fork_checkpoint;
 extern XBT_PUBLIC simgrid::config::Flag<bool> _sg_mc_ksm;
 extern XBT_PUBLIC simgrid::config::Flag<std::string> _sg_mc_property_file;
 extern XBT_PUBLIC simgrid::config::Flag<bool> _sg_mc_comms_determinism;
@@ -22,6 +24,8 @@ extern XBT_PRIVATE simgrid::config::Flag<bool> _sg_mc_timeout;
 extern XBT_PRIVATE simgrid::config::Flag<bool> _sg_mc_hash;
 extern XBT_PRIVATE simgrid::config::Flag<bool> _sg_mc_snapshot_fds;
 extern XBT_PRIVATE simgrid::config::Flag<int> _sg_mc_max_depth;
+extern XBT_PRIVATE simgrid::config::Flag<int> _sg_mc_workers;
+extern XBT_PRIVATE simgrid::config::Flag<int> _sg_mc_split_depth;
 extern "C" XBT_PUBLIC int _sg_mc_max_visited_states;
 extern XBT_PRIVATE simgrid::config::Flag<std::string> _sg_mc_dot_output_file;
 extern XBT_PRIVATE simgrid::config::Flag<bool> _sg_mc_termination;
@@ -18,6 +18,7 @@ namespace mc {
 class PageStore;
 class ChunkedData;
 class ModelChecker;
+class ForkCheckpoint;
 class AddressSpace;
 class RemoteClient;
 class Snapshot;
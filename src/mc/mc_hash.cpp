@@ -4,13 +4,14 @@
 /* This program is free software; you can redistribute it and/or modify it
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
+#include <algorithm>
 #include <cinttypes>
-
 #include <cstdint>
 
 #include "xbt/log.h"
 
 #include "mc/datatypes.h"
+#include "src/mc/ModelChecker.hpp"
 #include "src/mc/mc_hash.hpp"
 #include "src/mc/mc_private.hpp"
 #include "src/mc/mc_snapshot.hpp"
@@ -28,9 +29,9 @@ class djb_hash {
 
 public:
   template<class T>
-  void update(T& x)
+  void update(T const& x)
   {
-    state_ = (state_ << 5) + state_ + state_;
+    state_ = (state_ << 5) + state_ + static_cast<hash_type>(x);
   }
   hash_type value()
   {
@@ -40,18 +41,119 @@ public:
 
 }
 
+/** @brief Fingerprint of the state
+ *
+ *  Only the information that snapshot_compare() requires to be strictly equal is hashed (the actors, the used size
+ *  and the number of local variables of their stacks, the used size of the heap), so that two states considered equal
+ *  always get the same fingerprint. The global and local variables and the heap are compared modulo the addresses of
+ *  the heap blocks, and cannot be hashed here.
+ */
 hash_type hash(Snapshot const& snapshot)
 {
   XBT_DEBUG("START hash %i", snapshot.num_state);
   djb_hash hash;
-  // TODO, nb_processes
-  // TODO, heap_bytes_used
-  // TODO, root variables
-  // TODO, basic stack frame information
-  // TODO, stack frame local variables
-  XBT_DEBUG("END hash %i", snapshot.num_state);
+  hash.update(snapshot.enabled_processes.size());
+  for (pid_t pid : snapshot.enabled_processes)
+    hash.update(pid);
+  hash.update(snapshot.heap_bytes_used);
+  hash.update(snapshot.stacks.size());
+  for (std::size_t i = 0; i < snapshot.stacks.size(); i++) {
+    hash.update(snapshot.stack_sizes[i]);
+    hash.update(snapshot.stacks[i].process_index);
+    hash.update(snapshot.stacks[i].local_variables.size());
+  }
+  XBT_DEBUG("END hash %i: 0x%" PRIx64, snapshot.num_state, hash.value());
+  return hash.value();
+}
+
+static void hash_region(djb_hash& hash, RegionSnapshot const& region)
+{
+  hash.update(region.start().address());
+  hash.update(region.storage_type());
+  switch (region.storage_type()) {
+    case StorageType::Chunked: {
+      PageStore const& store   = mc_model_checker->page_store();
+      ChunkedData const& pages = region.page_data();
+      for (std::size_t i = 0; i < pages.page_count(); i++)
+        hash.update(store.get_page_hash(pages.pageno(i)));
+      break;
+    }
+    case StorageType::Privatized:
+      for (RegionSnapshot const& privatized : region.privatized_data())
+        hash_region(hash, privatized);
+      break;
+    default:
+      // The flat regions would have to be hashed byte per byte: same_memory() does not handle them anyway
+      break;
+  }
+}
+
+/** @brief Digest of the memory of the snapshot, computed from the hashes of its pages in the page store */
+hash_type content_hash(Snapshot const& snapshot)
+{
+  djb_hash hash;
+  for (auto const& region : snapshot.snapshot_regions)
+    if (region)
+      hash_region(hash, *region);
   return hash.value();
 }
 
+static bool same_pages(RegionSnapshot const& region1, RegionSnapshot const& region2)
+{
+  if (region1.start() != region2.start() || region1.size() != region2.size() ||
+      region1.storage_type() != region2.storage_type())
+    return false;
+  switch (region1.storage_type()) {
+    case StorageType::Chunked: {
+      ChunkedData const& pages1 = region1.page_data();
+      ChunkedData const& pages2 = region2.page_data();
+      return pages1.page_count() == pages2.page_count() &&
+             std::equal(pages1.pagenos(), pages1.pagenos() + pages1.page_count(), pages2.pagenos());
+    }
+    case StorageType::Privatized: {
+      std::vector<RegionSnapshot> const& privatized1 = region1.privatized_data();
+      std::vector<RegionSnapshot> const& privatized2 = region2.privatized_data();
+      if (privatized1.size() != privatized2.size())
+        return false;
+      for (std::size_t i = 0; i < privatized1.size(); i++)
+        if (not same_pages(privatized1[i], privatized2[i]))
+          return false;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/** @brief Whether two snapshots have exactly the same memory
+ *
+ *  The identical pages share the same storage in the page store, so it is enough to compare the page numbers of the
+ *  regions. Such snapshots are equal without having to run snapshot_compare().
+ */
+bool same_memory(Snapshot const& s1, Snapshot const& s2)
+{
+  if (s1.content_hash != s2.content_hash || s1.hash != s2.hash || s1.privatization_index != s2.privatization_index ||
+      s1.snapshot_regions.size() != s2.snapshot_regions.size())
+    return false;
+
+  for (std::size_t i = 0; i < s1.snapshot_regions.size(); i++) {
+    RegionSnapshot const* region1 = s1.snapshot_regions[i].get();
+    RegionSnapshot const* region2 = s2.snapshot_regions[i].get();
+    if (region1 == nullptr || region2 == nullptr) {
+      if (region1 != region2)
+        return false;
+    } else if (not same_pages(*region1, *region2))
+      return false;
+  }
+
+  /* The same heap areas must be ignored */
+  if (s1.to_ignore.size() != s2.to_ignore.size())
+    return false;
+  for (std::size_t i = 0; i < s1.to_ignore.size(); i++)
+    if (s1.to_ignore[i].address != s2.to_ignore[i].address || s1.to_ignore[i].size != s2.to_ignore[i].size)
+      return false;
+  return true;
+}
+
 }
 }
@@ -7,6 +7,7 @@
 #define SIMGRID_MC_HASH_HPP
 
 #include "xbt/base.h"
+#include <cstdint>
 #include "src/mc/mc_forward.hpp"
 
 namespace simgrid {
@@ -14,7 +15,12 @@ namespace mc {
 
 typedef std::uint64_t hash_type;
 
+/** Fingerprint of the state: the states that snapshot_compare() considers equal have the same fingerprint */
 XBT_PRIVATE hash_type hash(simgrid::mc::Snapshot const& snapshot);
+/** Digest of the memory of the snapshot, from the hashes of its pages */
+XBT_PRIVATE hash_type content_hash(simgrid::mc::Snapshot const& snapshot);
+/** Whether the two snapshots have exactly the same memory content */
+XBT_PRIVATE bool same_memory(simgrid::mc::Snapshot const& s1, simgrid::mc::Snapshot const& s2);
 
 }
 }
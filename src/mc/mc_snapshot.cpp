@@ -149,6 +149,7 @@ Snapshot::Snapshot(RemoteClient* process, int _num_state)
     , enabled_processes()
     , privatization_index(0)
     , hash(0)
+    , content_hash(0)
 {
 
 }
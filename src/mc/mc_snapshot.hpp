@@ -121,7 +121,8 @@ public:
   std::vector<std::size_t> stack_sizes;
   std::vector<s_mc_snapshot_stack_t> stacks;
   std::vector<simgrid::mc::IgnoredHeapRegion> to_ignore;
-  std::uint64_t hash;
+  std::uint64_t hash;         /* fingerprint of the state, see simgrid::mc::hash() */
+  std::uint64_t content_hash; /* digest of the memory, see simgrid::mc::content_hash() */
   std::vector<s_mc_snapshot_ignored_data_t> ignored_data;
   std::vector<s_fd_infos_t> current_fds;
 };
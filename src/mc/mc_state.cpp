@@ -10,6 +10,8 @@
 #include "xbt/log.h"
 #include "xbt/sysdep.h"
 
+#include "src/mc/ModelChecker.hpp"
+#include "src/mc/Session.hpp"
 #include "src/mc/Transition.hpp"
 #include "src/mc/mc_comm_pattern.hpp"
 #include "src/mc/mc_private.hpp"
@@ -34,7 +36,11 @@ State::State(unsigned long state_number) : num(state_number)
 
   actorStates.resize(MC_smx_get_maxpid());
   /* Stateful model checking */
-  if ((_sg_mc_checkpoint > 0 && (state_number % _sg_mc_checkpoint == 0)) || _sg_mc_termination) {
+  if (simgrid::mc::session->forkCheckpoints() && _sg_mc_checkpoint > 0 && (state_number % _sg_mc_checkpoint == 0) &&
+      not _sg_mc_termination) {
+    /* The forks can only be restored: the snapshots are still needed to compare the states */
+    checkpoint = std::make_shared<simgrid::mc::ForkCheckpoint>();
+  } else if ((_sg_mc_checkpoint > 0 && (state_number % _sg_mc_checkpoint == 0)) || _sg_mc_termination) {
     system_state = simgrid::mc::take_snapshot(num);
     if (_sg_mc_comms_determinism || _sg_mc_send_determinism) {
       MC_state_copy_incomplete_communications_pattern(this);
@@ -121,6 +121,9 @@ public:
   /** Snapshot of system state (if needed) */
   std::shared_ptr<simgrid::mc::Snapshot> system_state;
 
+  /** Checkpoint of the system state, instead of the snapshot (with model-check/fork-checkpoint) */
+  std::shared_ptr<simgrid::mc::ForkCheckpoint> checkpoint;
+
   // For CommunicationDeterminismChecker
   std::vector<std::vector<simgrid::mc::PatternCommunication>> incomplete_comm_pattern;
   std::vector<unsigned> communicationIndices;
@@ -4,11 +4,15 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include <cerrno>
+#include <csignal>
 #include <cstdlib>
+#include <cstring>
 
 #include <sys/ptrace.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <xbt/log.h>
 #include <xbt/mmalloc.h>
@@ -123,6 +127,30 @@ void Client::handleActorEnabled(s_mc_message_actor_enabled_t* msg)
   s_mc_message_int_t answer{MC_MESSAGE_ACTOR_ENABLED_REPLY, res};
   channel_.send(answer);
 }
+/** Fork a copy of the application, which stays frozen as a checkpoint of the current state
+ *
+ *  The model-checker traces the forks of the application: the copy is stopped as soon as it is created. Every time
+ *  that the model-checker restores this checkpoint, it resumes the copy, which forks again: the new process goes on
+ *  from here (waiting for the messages of the model-checker) while the copy stops again, ready for the next restore.
+ */
+void Client::handleFork(s_mc_message_t* msg)
+{
+  pid_t pid = fork();
+  if (pid < 0)
+    xbt_die("Could not fork a checkpoint: %s", strerror(errno));
+  if (pid > 0)
+    return;
+  do {
+    // Reap the processes forked by the previous restores, which were killed since then:
+    while (waitpid(-1, nullptr, WNOHANG) > 0)
+      continue;
+    pid = fork();
+    if (pid < 0)
+      xbt_die("Could not restore a checkpoint: %s", strerror(errno));
+    if (pid > 0)
+      raise(SIGSTOP);
+  } while (pid > 0);
+}
 
 void Client::handleMessages()
 {
@@ -170,6 +198,12 @@ void Client::handleMessages()
         handleActorEnabled((s_mc_message_actor_enabled_t*)message_buffer);
         break;
 
+      case MC_MESSAGE_FORK:
+        xbt_assert(received_size == sizeof(s_mc_message_t), "Unexpected size for MESSAGE_FORK (%zd != %zu)",
+                   received_size, sizeof(s_mc_message_t));
+        handleFork(message);
+        break;
+
       default:
         xbt_die("Received unexpected message %s (%i)", MC_message_type_name(message->type), message->type);
         break;
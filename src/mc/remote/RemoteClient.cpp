@@ -8,8 +8,10 @@
 #include <algorithm>
 #include <cassert>
 #include <cerrno>
+#include <climits>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -20,6 +22,7 @@
 #include <fcntl.h>
 #include <sys/mman.h> // PROT_*
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <pthread.h>
@@ -231,6 +234,26 @@ void RemoteClient::init()
   this->unw_underlying_context    = simgrid::unw::create_context(this->unw_underlying_addr_space, this->pid_);
 }
 
+/** Follow another process, with the same address space as the current one
+ *
+ *  This is used when the model-checked process is replaced by one of its forks, which are exact copies of it.
+ */
+void RemoteClient::reattach(pid_t pid)
+{
+  int fd = open_vm(pid, O_RDWR);
+  if (fd < 0)
+    xbt_die("Could not open file for process virtual address space");
+  close(this->memory_file);
+  this->memory_file = fd;
+  this->pid_        = pid;
+  this->running_    = true;
+
+  if (this->unw_underlying_context)
+    _UPT_destroy(this->unw_underlying_context);
+  this->unw_underlying_context = simgrid::unw::create_context(this->unw_underlying_addr_space, this->pid_);
+  this->clear_cache();
+}
+
 RemoteClient::~RemoteClient()
 {
   if (this->memory_file >= 0)
@@ -469,9 +492,76 @@ const void* RemoteClient::read_bytes(void* buffer, std::size_t size, RemotePtr<v
     }
 #endif
   }
+  RemoteRead read{buffer, size, address};
+  this->read_batch(&read, 1);
+  return buffer;
+}
+
+void RemoteClient::pread_bytes(void* buffer, std::size_t size, RemotePtr<void> address) const
+{
+  read_stats_.syscalls++;
+  read_stats_.bytes += size;
   if (pread_whole(this->memory_file, buffer, size, (size_t)address.address()) < 0)
     xbt_die("Read at %p from process %lli failed", (void*)address.address(), (long long)this->pid_);
-  return buffer;
+}
+
+/** Reads several areas of the memory of the process
+ *
+ *  The areas are read with as few process_vm_readv() calls as possible (scatter/gather), instead of one pread() on
+ *  /proc/pid/mem per area. Unlike read_bytes(), no translation of the privatized addresses is done.
+ */
+void RemoteClient::read_batch(const RemoteRead* reads, std::size_t count) const
+{
+  std::size_t done = 0;
+#ifdef __linux__
+  std::vector<struct iovec> local_iov;
+  std::vector<struct iovec> remote_iov;
+  while (use_process_vm_ && done < count) {
+    std::size_t n = std::min<std::size_t>(count - done, IOV_MAX);
+    local_iov.resize(n);
+    remote_iov.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+      local_iov[i].iov_base  = reads[done + i].buffer;
+      local_iov[i].iov_len   = reads[done + i].size;
+      remote_iov[i].iov_base = (void*)reads[done + i].address.address();
+      remote_iov[i].iov_len  = reads[done + i].size;
+    }
+
+    ssize_t res = process_vm_readv(this->pid_, local_iov.data(), n, remote_iov.data(), n, 0);
+    read_stats_.syscalls++;
+    if (res < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == ENOSYS || errno == EPERM) {
+        XBT_VERB("process_vm_readv() is not usable (%s), reading through /proc/%lli/mem", std::strerror(errno),
+                 (long long)this->pid_);
+        use_process_vm_ = false;
+        break;
+      }
+      // Let pread report which area cannot be read:
+      pread_bytes(reads[done].buffer, reads[done].size, reads[done].address);
+      done++;
+      continue;
+    }
+    read_stats_.bytes += res;
+
+    // Skip the areas that were completely read. A partial read stops at an area that is not entirely readable:
+    // read the rest of it with pread, which reports the error if any.
+    std::size_t remaining = res;
+    std::size_t end       = done + n;
+    while (done < end && reads[done].size <= remaining) {
+      remaining -= reads[done].size;
+      done++;
+    }
+    if (done < end && (remaining > 0 || res == 0)) {
+      pread_bytes((char*)reads[done].buffer + remaining, reads[done].size - remaining,
+                  remote((char*)reads[done].address.address() + remaining));
+      done++;
+    }
+  }
+#endif
+  for (; done < count; done++)
+    pread_bytes(reads[done].buffer, reads[done].size, reads[done].address);
 }
 
 /** Write data to a process memory
@@ -71,6 +71,19 @@ struct IgnoredHeapRegion {
   std::size_t size;
 };
 
+/** A part of a batched read: `size` bytes at `address` in the model-checked process are copied to `buffer` */
+struct RemoteRead {
+  void* buffer;
+  std::size_t size;
+  RemotePtr<void> address;
+};
+
+/** Amount of data read from the model-checked process, and number of system calls used for that */
+struct RemoteReadStats {
+  unsigned long syscalls = 0;
+  unsigned long long bytes = 0;
+};
+
 /** The Model-Checked process, seen from the MCer perspective
  *
  *  This class is mixing a lot of different responsibilities and is tied
@@ -99,6 +112,7 @@ public:
   RemoteClient(pid_t pid, int sockfd);
   ~RemoteClient();
   void init();
+  void reattach(pid_t pid);
 
   RemoteClient(RemoteClient const&) = delete;
   RemoteClient(RemoteClient&&)      = delete;
@@ -108,6 +122,9 @@ public:
   // Read memory:
   const void* read_bytes(void* buffer, std::size_t size, RemotePtr<void> address, int process_index = ProcessIndexAny,
                          ReadOptions options = ReadOptions::none()) const override;
+  void read_batch(const RemoteRead* reads, std::size_t count) const;
+  void read_batch(std::vector<RemoteRead> const& reads) const { read_batch(reads.data(), reads.size()); }
+  RemoteReadStats const& read_stats() const { return read_stats_; }
 
   void read_variable(const char* name, void* target, size_t size) const;
   template <class T> void read_variable(const char* name, T* target) const
@@ -222,6 +239,7 @@ private:
   void refresh_heap();
   void refresh_malloc_info();
   void refresh_simix();
+  void pread_bytes(void* buffer, std::size_t size, RemotePtr<void> address) const;
 
   pid_t pid_ = -1;
   Channel channel_;
@@ -230,6 +248,8 @@ private:
   RemotePtr<void> maestro_stack_start_;
   RemotePtr<void> maestro_stack_end_;
   int memory_file = -1;
+  mutable bool use_process_vm_ = true; /* whether process_vm_readv() works, or we must use memory_file */
+  mutable RemoteReadStats read_stats_;
   std::vector<IgnoredRegion> ignored_regions_;
   bool privatized_ = false;
   std::vector<s_stack_region_t> stack_areas_;
@@ -52,6 +52,9 @@ const char* MC_message_type_name(e_mc_message_type type)
     case MC_MESSAGE_ACTOR_ENABLED_REPLY:
       return "ACTOR_ENABLED_REPLY";
 
+    case MC_MESSAGE_FORK:
+      return "FORK";
+
     default:
       return "?";
   }
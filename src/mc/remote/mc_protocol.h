@@ -43,7 +43,9 @@ enum e_mc_message_type {
   // MCer request to finish the restoration:
   MC_MESSAGE_RESTORE,
   MC_MESSAGE_ACTOR_ENABLED,
-  MC_MESSAGE_ACTOR_ENABLED_REPLY
+  MC_MESSAGE_ACTOR_ENABLED_REPLY,
+  // MCer request to fork a checkpoint of the current state:
+  MC_MESSAGE_FORK
 };
 
 #define MC_MESSAGE_LENGTH 512
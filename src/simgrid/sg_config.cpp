@@ -262,6 +262,19 @@ void sg_config_init(int *argc, char **argv)
                              "Maximum number of concurrent variables in the maxmim system. Also limits the number of "
                              "processes on each host, at higher level. (default: -1 means no such limitation)");
 
+  simgrid::config::bind_flag(sg_maxmin_nthreads, "maxmin/nthreads",
+                             "Number of threads used to solve the independent parts of the maxmin systems in parallel "
+                             "when maxmin/split-components is set (default: 1)");
+
+  simgrid::config::bind_flag(sg_maxmin_split_components, "maxmin/split-components",
+                             "Solve the independent parts of the maxmin systems separately. The computed sharing may "
+                             "then differ from the global resolution in the last digits (default: no)");
+
+  simgrid::config::bind_flag(sg_maxmin_solver, "maxmin/solver", "Implementation of the maxmin solver",
+                             {{"default", "Solver working directly on the linked representation of the system"},
+                              {"flat", "Solver working on a flat copy of the system (faster on large systems)"}},
+                             [](const std::string&) {});
+
   /* The parameters of network models */
 
   sg_latency_factor = 13.01; // comes from the default LV08 network model
@@ -334,7 +334,7 @@ smx_actor_t SIMIX_process_create(const char* name, std::function<void()> code, v
   /* Now insert it in the global process list and in the process to run list */
   simix_global->process_list[process->pid] = process;
   XBT_DEBUG("Inserting %s(%s) in the to_run list", process->get_cname(), host->get_cname());
-  simix_global->process_to_run.push_back(process);
+  SIMIX_process_schedule(process);
   intrusive_ptr_add_ref(process);
 
   /* The onCreation() signal must be delayed until there, where the pid and everything is set */
@@ -389,7 +389,7 @@ smx_actor_t SIMIX_process_attach(const char* name, void* data, const char* hostn
   /* Now insert it in the global process list and in the process to run list */
   simix_global->process_list[process->pid] = process;
   XBT_DEBUG("Inserting %s(%s) in the to_run list", process->get_cname(), host->get_cname());
-  simix_global->process_to_run.push_back(process);
+  SIMIX_process_schedule(process);
   intrusive_ptr_add_ref(process);
 
 
@@ -417,6 +417,19 @@ void SIMIX_process_detach()
   context->attach_stop();
 }
 
+/**
+ * \brief Adds a process to simix_global->process_to_run, unless it is already there.
+ *
+ * This takes a constant time, and keeps the processes in the order of their first insertion during the sub-round.
+ */
+void SIMIX_process_schedule(smx_actor_t process)
+{
+  if (process->scheduled_round == simix_global->process_to_run_round)
+    return;
+  process->scheduled_round = simix_global->process_to_run_round;
+  simix_global->process_to_run.push_back(process);
+}
+
 /**
  * \brief Executes the processes from simix_global->process_to_run.
  *
@@ -432,6 +445,7 @@ void SIMIX_process_runall()
 
   simix_global->process_to_run.swap(simix_global->process_that_ran);
   simix_global->process_to_run.clear();
+  simix_global->process_to_run_round++;
 }
 
 /**
@@ -500,11 +514,9 @@ void SIMIX_process_kill(smx_actor_t process, smx_actor_t issuer) {
 
     process->waiting_synchro = nullptr;
   }
-  if (std::find(begin(simix_global->process_to_run), end(simix_global->process_to_run), process) ==
-          end(simix_global->process_to_run) &&
-      process != issuer) {
+  if (process != issuer) {
     XBT_DEBUG("Inserting %s in the to_run list", process->name.c_str());
-    simix_global->process_to_run.push_back(process);
+    SIMIX_process_schedule(process);
   }
 }
 
@@ -540,11 +552,9 @@ void SIMIX_process_throw(smx_actor_t process, xbt_errcat_t cat, int value, const
         boost::dynamic_pointer_cast<simgrid::kernel::activity::SleepImpl>(process->waiting_synchro);
     if (sleep != nullptr) {
       SIMIX_process_sleep_destroy(process->waiting_synchro);
-      if (std::find(begin(simix_global->process_to_run), end(simix_global->process_to_run), process) ==
-              end(simix_global->process_to_run) &&
-          process != SIMIX_process_self()) {
+      if (process != SIMIX_process_self()) {
         XBT_DEBUG("Inserting %s in the to_run list", process->name.c_str());
-        simix_global->process_to_run.push_back(process);
+        SIMIX_process_schedule(process);
       }
     }
 
@@ -68,6 +68,7 @@ public:
   bool blocked      = false;
   bool suspended    = false;
   bool auto_restart = false;
+  unsigned long scheduled_round = 0; /* simix_global->process_to_run_round when it was last added to process_to_run */
 
   smx_activity_t waiting_synchro = nullptr; /* the current blocking synchro if any */
   std::list<smx_activity_t> comms;          /* the current non-blocking communication synchros */
@@ -140,6 +141,7 @@ XBT_PRIVATE smx_actor_t SIMIX_process_create(const char* name, std::function<voi
                                              std::unordered_map<std::string, std::string>* properties,
                                              smx_actor_t parent_process);
 
+XBT_PRIVATE void SIMIX_process_schedule(smx_actor_t process);
 XBT_PRIVATE void SIMIX_process_runall();
 XBT_PRIVATE void SIMIX_process_kill(smx_actor_t process, smx_actor_t issuer);
 XBT_PRIVATE void SIMIX_process_killall(smx_actor_t issuer);
@@ -8,8 +8,12 @@
 #include <cerrno>
 #include <cstring>
 
-#include <utility>
+#include <algorithm>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <xbt/config.hpp>
 #include <xbt/log.h>
@@ -54,6 +58,9 @@ static std::pair<const char*, simgrid::kernel::context::ContextFactoryInitialize
 #if HAVE_THREAD_CONTEXTS
   { "thread", &simgrid::kernel::context::thread_factory },
 #endif
+#if HAVE_RAW_CONTEXTS
+  { "shared", &simgrid::kernel::context::shared_factory },
+#endif
 };
 
 static_assert(sizeof(context_factories) != 0, "No context factories are enabled for this build");
@@ -76,6 +83,10 @@ static simgrid::config::Flag<std::string> context_factory_name(
   (std::string("Possible values: ")+contexts_list()).c_str(),
   context_factories[0].first);
 
+static simgrid::config::Flag<bool> context_stack_pool(
+    "contexts/stack-pool", "Recycle the stacks of the terminated actors, and allocate them by large memory regions",
+    false);
+
 unsigned smx_context_stack_size;
 int smx_context_stack_size_was_set = 0;
 unsigned smx_context_guard_size;
@@ -90,6 +101,131 @@ static int smx_parallel_contexts = 1;
 static int smx_parallel_threshold = 2;
 static e_xbt_parmap_mode_t smx_parallel_synchronization_mode = XBT_PARMAP_DEFAULT;
 
+#ifndef _WIN32
+namespace {
+/** @brief Pool of the actor stacks
+ *
+ * The stacks are carved out of large memory regions, reserved without committing memory (the pages are only
+ * allocated by the system when touched). The stacks of the terminated actors are kept for the next created actors,
+ * so that in steady state, creating an actor needs neither mmap nor mprotect: the guard pages are protected once,
+ * when the region is created. The recycled stacks are zeroed like the ones allocated one by one.
+ *
+ * The pool is locked, since nothing prevents the contexts from being created or destroyed by parallel workers.
+ */
+class StackPool {
+public:
+  static constexpr std::size_t stacks_per_region = 64;
+
+  void* get()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty() && not grow())
+      return nullptr;
+    void* stack = free_.back();
+    free_.pop_back();
+    in_use_++;
+    peak_ = std::max(peak_, in_use_);
+    return stack;
+  }
+
+  /** Gives the stack back to the pool, or returns false if it was not allocated by the pool */
+  bool put(void* stack)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto region = regions_.upper_bound(static_cast<char*>(stack));
+    if (region == regions_.begin() || static_cast<char*>(stack) >= (--region)->second)
+      return false;
+    clean(stack);
+    free_.push_back(stack);
+    in_use_--;
+    return true;
+  }
+
+  void report() const
+  {
+    if (regions_.empty())
+      return;
+    XBT_VERB("Actor stacks: %zu in use, at most %zu at once, %zu KiB reserved in %zu regions", in_use_, peak_,
+             regions_.size() * stacks_per_region * slot_size_ / 1024, regions_.size());
+  }
+
+  /** Unmaps all the regions, if none of their stacks is in use */
+  void clear()
+  {
+    if (in_use_ > 0)
+      return;
+    for (auto const& region : regions_)
+      munmap(region.first, region.second - region.first);
+    regions_.clear();
+    free_.clear();
+    peak_ = 0;
+  }
+
+private:
+  /** Zeroes a stack given back to the pool. On Linux, this also gives its pages back to the system. */
+  void clean(void* stack) const
+  {
+    std::size_t size = slot_size_ - smx_context_guard_size;
+#ifdef __linux__
+    if (madvise(stack, size, MADV_DONTNEED) == 0)
+      return;
+#endif
+    memset(stack, 0, size);
+  }
+
+  bool grow()
+  {
+#if !defined(PTH_STACKGROWTH) || (PTH_STACKGROWTH != -1)
+    if (smx_context_guard_size > 0) // The guard pages below the stacks would be useless: let the regular allocation fail
+      return false;
+#endif
+    /* The stacks of a pool all have the same size: do not use the pool if the size changed since its creation */
+    std::size_t slot_size = smx_context_stack_size + smx_context_guard_size;
+    slot_size             = (slot_size + xbt_pagesize - 1) & ~(static_cast<std::size_t>(xbt_pagesize) - 1);
+    if (regions_.empty())
+      slot_size_ = slot_size;
+    else if (slot_size != slot_size_)
+      return false;
+
+    std::size_t size = stacks_per_region * slot_size_;
+    void* mem        = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+      XBT_VERB("Cannot reserve a region of %zu stacks (%s), allocate them one by one", stacks_per_region,
+               strerror(errno));
+      return false;
+    }
+    char* region = static_cast<char*>(mem);
+    regions_.insert({region, region + size});
+    XBT_DEBUG("New region of %zu stacks at %p", stacks_per_region, region);
+
+    /* Last slot first, so that the stacks are used in the order of the addresses */
+    for (std::size_t i = stacks_per_region; i-- > 0;) {
+      char* slot = region + i * slot_size_;
+      if (smx_context_guard_size > 0 && mprotect(slot, smx_context_guard_size, PROT_NONE) == -1)
+        xbt_die("Failed to protect stack: %s.\n"
+                "If you are running a lot of actors, you may be exceeding the amount of mappings allowed per process.\n"
+                "On Linux systems, change this value with sudo sysctl -w vm.max_map_count=newvalue (default value: "
+                "65536)\n"
+                "Please see http://simgrid.gforge.inria.fr/simgrid/latest/doc/html/options.html#options_virt for more "
+                "info.",
+                strerror(errno));
+      free_.push_back(slot + smx_context_guard_size);
+    }
+    return true;
+  }
+
+  std::map<char*, char*> regions_; // start -> end of each region
+  std::vector<void*> free_;
+  std::size_t slot_size_ = 0;
+  std::size_t in_use_    = 0;
+  std::size_t peak_      = 0;
+  std::mutex mutex_;
+};
+
+StackPool stack_pool;
+}
+#endif
+
 /**
  * This function is called by SIMIX_global_init() to initialize the context module.
  */
@@ -151,6 +287,9 @@ void SIMIX_context_mod_init()
     XBT_ERROR("  (boost was disabled at compilation time on this machine -- check configure logs for details. Did you install the libboost-context-dev package?)");
 #endif
     XBT_ERROR("  thread: slow portability layer using pthreads as provided by gcc");
+#if HAVE_RAW_CONTEXTS
+    XBT_ERROR("  shared: raw contexts running on a few shared stacks, saving only the used part of each actor's stack");
+#endif
     xbt_die("Please use a valid factory.");
   }
 }
@@ -162,13 +301,21 @@ void SIMIX_context_mod_exit()
 {
   delete simix_global->context_factory;
   simix_global->context_factory = nullptr;
+#ifndef _WIN32
+  stack_pool.report();
+  stack_pool.clear();
+#endif
 }
 
 void *SIMIX_context_stack_new()
 {
-  void *stack;
+  void *stack = nullptr;
 
-  if (smx_context_guard_size > 0 && not MC_is_active()) {
+#ifndef _WIN32
+  if (context_stack_pool && not MC_is_active())
+    stack = stack_pool.get();
+#endif
+  if (stack == nullptr && smx_context_guard_size > 0 && not MC_is_active()) {
 
 #if !defined(PTH_STACKGROWTH) || (PTH_STACKGROWTH != -1)
     xbt_die("Stack overflow protection is known to be broken on your system: you stacks grow upwards (or detection is "
@@ -204,7 +351,7 @@ void *SIMIX_context_stack_new()
     }
 #endif
     stack = (char *)stack + smx_context_guard_size;
-  } else {
+  } else if (stack == nullptr) {
     stack = xbt_malloc0(smx_context_stack_size);
   }
 
@@ -228,6 +375,9 @@ void SIMIX_context_stack_delete(void *stack)
 #endif
 
 #ifndef _WIN32
+  if (stack_pool.put(stack))
+    return;
+
   if (smx_context_guard_size > 0 && not MC_is_active()) {
     stack = (char *)stack - smx_context_guard_size;
     if (mprotect(stack, smx_context_guard_size, PROT_READ | PROT_WRITE) == -1) {
@@ -18,6 +18,7 @@
 #include "src/smpi/include/smpi_process.hpp"
 #include "src/surf/StorageImpl.hpp"
 #include "src/surf/xml/platf.hpp"
+#include "xbt/parmap.hpp"
 
 #if SIMGRID_HAVE_MC
 #include "src/mc/mc_private.hpp"
@@ -31,6 +32,7 @@
 
 #include <boost/heap/fibonacci_heap.hpp>
 #include <csignal>
+#include <deque>
 
 XBT_LOG_NEW_CATEGORY(simix, "All SIMIX categories");
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(simix_kernel, simix, "Logging specific to SIMIX (kernel)");
@@ -160,9 +162,20 @@ namespace simix {
 
 simgrid::config::Flag<double> breakpoint{"simix/breakpoint",
                                          "When non-negative, raise a SIGTRAP after given (simulated) time", -1.0};
+
+XBT_THREAD_LOCAL bool answers_deferred = false;
 }
 }
 
+static simgrid::config::Flag<bool> parallel_simcalls{
+    "contexts/parallel-simcalls",
+    "Whether the independent simcalls issued during a scheduling round are handled in parallel (with parallel "
+    "contexts only)",
+    false};
+static simgrid::xbt::Parmap<std::vector<smx_actor_t>*>* simcall_parmap = nullptr;
+static unsigned long parallel_simcalls_count = 0; // simcalls handled by the threads of simcall_parmap
+static unsigned long parallel_batches_count  = 0;
+
 static std::function<void()> maestro_code;
 void SIMIX_set_maestro(void (*code)(void*), void* data)
 {
@@ -276,6 +289,12 @@ void SIMIX_clean()
   simix_global->process_to_destroy.clear();
   simix_global->process_list.clear();
 
+  if (simcall_parmap != nullptr)
+    XBT_VERB("%lu simcalls were handled in parallel, in %lu batches", parallel_simcalls_count,
+             parallel_batches_count);
+  delete simcall_parmap;
+  simcall_parmap = nullptr;
+
   xbt_os_mutex_destroy(simix_global->mutex);
   simix_global->mutex = nullptr;
 #if SIMGRID_HAVE_MC
@@ -381,6 +400,119 @@ static bool SIMIX_execute_tasks()
   return true;
 }
 
+/** @brief Resource on which a simcall only depends, if it can be handled in parallel with the other simcalls
+ *
+ * Such simcalls only read the state of the simulation, but for the returned resource, and then answer their issuer.
+ * The other simcalls (returning nullptr) may start, finish or match activities and must be handled alone.
+ */
+static void* simcall_parallel_resource(smx_simcall_t simcall)
+{
+  switch (simcall->call) {
+    case SIMCALL_COMM_TEST: {
+      simgrid::kernel::activity::ActivityImpl* comm = simcall_comm_test__getraw__comm(simcall);
+      return (comm->state_ == SIMIX_WAITING || comm->state_ == SIMIX_RUNNING) ? simcall->issuer : nullptr;
+    }
+    case SIMCALL_COMM_TESTANY: {
+      simgrid::kernel::activity::ActivityImpl** comms = simcall_comm_testany__getraw__comms(simcall);
+      size_t count                                   = simcall_comm_testany__getraw__count(simcall);
+      for (size_t i = 0; i < count; i++)
+        if (comms[i]->state_ != SIMIX_WAITING && comms[i]->state_ != SIMIX_RUNNING)
+          return nullptr;
+      return simcall->issuer;
+    }
+    case SIMCALL_EXECUTION_TEST: {
+      simgrid::kernel::activity::ActivityImpl* exec = simcall_execution_test__getraw__execution(simcall);
+      return (exec->state_ == SIMIX_WAITING || exec->state_ == SIMIX_RUNNING) ? simcall->issuer : nullptr;
+    }
+    case SIMCALL_MUTEX_TRYLOCK:
+      return simcall_mutex_trylock__getraw__mutex(simcall);
+    default:
+      return nullptr;
+  }
+}
+
+static void handle_simcall_group(std::vector<smx_actor_t>* group)
+{
+  simgrid::simix::answers_deferred = true;
+  for (smx_actor_t const& process : *group)
+    SIMIX_simcall_handle(&process->simcall, 0);
+  simgrid::simix::answers_deferred = false;
+}
+
+/** @brief Handles the simcalls of the actors that ran during the last scheduling round
+ *
+ * The simcalls are handled in the order of process_that_ran. With contexts/parallel-simcalls, the consecutive simcalls
+ * that can be handled in parallel are grouped by resource, and the groups are handled by the threads of a parmap. Their
+ * issuers are only rescheduled afterward, in the order of process_that_ran, so that the simulation is the same as when
+ * the simcalls are handled one after the other.
+ */
+static void SIMIX_handle_simcalls()
+{
+  std::vector<smx_actor_t> const& ran = simix_global->process_that_ran;
+  if (not parallel_simcalls || not SIMIX_context_is_parallel() || MC_is_active() || MC_record_replay_is_active() ||
+      ran.size() < static_cast<size_t>(SIMIX_context_get_parallel_threshold())) {
+    for (smx_actor_t const& process : ran) {
+      if (process->simcall.call != SIMCALL_NONE) {
+        process->context->load_stack();
+        SIMIX_simcall_handle(&process->simcall, 0);
+      }
+    }
+    return;
+  }
+
+  if (simcall_parmap == nullptr)
+    simcall_parmap = new simgrid::xbt::Parmap<std::vector<smx_actor_t>*>(SIMIX_context_get_nthreads(),
+                                                                         SIMIX_context_get_parallel_mode());
+  static std::vector<smx_actor_t> batch;
+  static std::deque<std::vector<smx_actor_t>> groups; // a deque, so that the groups do not move when adding some
+  static std::vector<std::vector<smx_actor_t>*> group_list;
+  static std::unordered_map<void*, std::vector<smx_actor_t>*> group_of_resource;
+
+  auto it = ran.begin();
+  while (it != ran.end()) {
+    batch.clear();
+    group_list.clear();
+    group_of_resource.clear();
+    for (; it != ran.end(); ++it) {
+      smx_actor_t process = *it;
+      if (process->simcall.call == SIMCALL_NONE)
+        continue;
+      void* resource = simcall_parallel_resource(&process->simcall);
+      if (resource == nullptr)
+        break;
+      batch.push_back(process);
+      auto elm = group_of_resource.emplace(resource, nullptr);
+      if (elm.second) {
+        if (groups.size() == group_list.size())
+          groups.emplace_back();
+        elm.first->second = &groups[group_list.size()];
+        elm.first->second->clear();
+        group_list.push_back(elm.first->second);
+      }
+      elm.first->second->push_back(process);
+    }
+
+    if (group_list.size() > 1) {
+      XBT_DEBUG("Handle %zu simcalls in parallel, on %zu resources", batch.size(), group_list.size());
+      simcall_parmap->apply(handle_simcall_group, group_list);
+      parallel_simcalls_count += batch.size();
+      parallel_batches_count++;
+      for (smx_actor_t const& process : batch)
+        if (process->simcall.call == SIMCALL_NONE) // answered
+          SIMIX_process_schedule(process);
+    } else {
+      for (smx_actor_t const& process : batch)
+        SIMIX_simcall_handle(&process->simcall, 0);
+    }
+
+    if (it != ran.end()) { // This one has to be handled alone
+      (*it)->context->load_stack();
+      SIMIX_simcall_handle(&(*it)->simcall, 0);
+      ++it;
+    }
+  }
+}
+
 /**
  * \ingroup SIMIX_API
  * \brief Run the main simulation loop.
@@ -477,11 +609,7 @@ void SIMIX_run()
        *   That would thus be a pure waste of time.
        */
 
-      for (smx_actor_t const& process : simix_global->process_that_ran) {
-        if (process->simcall.call != SIMCALL_NONE) {
-          SIMIX_simcall_handle(&process->simcall, 0);
-        }
-      }
+      SIMIX_handle_simcalls();
 
       SIMIX_execute_tasks();
       do {
@@ -4,6 +4,7 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include <algorithm>
+#include <vector>
 
 #include <boost/range/algorithm.hpp>
 
@@ -29,8 +30,8 @@ static void SIMIX_comm_copy_data(smx_activity_t comm);
 static void SIMIX_comm_start(simgrid::kernel::activity::CommImplPtr synchro);
 
 /**
- *  \brief Checks if there is a communication activity queued in a deque matching our needs
- *  \param deque where to search into
+ *  \brief Checks if there is a communication activity queued in a mailbox queue matching our needs
+ *  \param queue where to search into
  *  \param type The type of communication we are looking for (comm_send, comm_recv)
  *  \param match_fun the function to apply
  *  \param this_user_data additional parameter to the match_fun
@@ -39,38 +40,23 @@ static void SIMIX_comm_start(simgrid::kernel::activity::CommImplPtr synchro);
  *  \return The communication activity if found, nullptr otherwise
  */
 static simgrid::kernel::activity::CommImplPtr
-_find_matching_comm(boost::circular_buffer_space_optimized<smx_activity_t>* deque, e_smx_comm_type_t type,
+_find_matching_comm(simgrid::kernel::activity::CommQueue* queue, e_smx_comm_type_t type,
                     int (*match_fun)(void*, void*, simgrid::kernel::activity::CommImpl*), void* this_user_data,
                     simgrid::kernel::activity::CommImplPtr my_synchro, bool remove_matching)
 {
-  void* other_user_data = nullptr;
-
-  for(auto it = deque->begin(); it != deque->end(); it++){
-    simgrid::kernel::activity::CommImplPtr comm =
-        boost::dynamic_pointer_cast<simgrid::kernel::activity::CommImpl>(std::move(*it));
+  simgrid::kernel::activity::CommImplPtr comm =
+      queue->find_matching(type, match_fun, this_user_data, my_synchro, remove_matching);
+  if (not comm) {
+    XBT_DEBUG("No matching communication synchro found");
+    return nullptr;
+  }
 
-    if (comm->type == SIMIX_COMM_SEND) {
-      other_user_data = comm->src_data;
-    } else if (comm->type == SIMIX_COMM_RECEIVE) {
-      other_user_data = comm->dst_data;
-    }
-    if (comm->type == type && (match_fun == nullptr || match_fun(this_user_data, other_user_data, comm.get())) &&
-        (not comm->match_fun || comm->match_fun(other_user_data, this_user_data, my_synchro.get()))) {
-      XBT_DEBUG("Found a matching communication synchro %p", comm.get());
-      if (remove_matching)
-        deque->erase(it);
+  XBT_DEBUG("Found a matching communication synchro %p", comm.get());
 #if SIMGRID_HAVE_MC
-      comm->mbox_cpy = comm->mbox;
+  comm->mbox_cpy = comm->mbox;
 #endif
-      comm->mbox = nullptr;
-      return comm;
-    }
-    XBT_DEBUG("Sorry, communication synchro %p does not match our needs:"
-              " its type is %d but we are looking for a comm of type %d (or maybe the filtering didn't match)",
-              comm.get(), (int)comm->type, (int)type);
-  }
-  XBT_DEBUG("No matching communication synchro found");
-  return nullptr;
+  comm->mbox = nullptr;
+  return comm;
 }
 
 /******************************************************************************/
@@ -100,6 +86,9 @@ XBT_PRIVATE smx_activity_t simcall_HANDLER_comm_isend(
   /* Prepare a synchro describing us, so that it gets passed to the user-provided filter of other side */
   simgrid::kernel::activity::CommImplPtr this_comm =
       simgrid::kernel::activity::CommImplPtr(new simgrid::kernel::activity::CommImpl(SIMIX_COMM_SEND));
+  /* The mailbox uses them to index our communication if it gets queued */
+  this_comm->match_fun = match_fun;
+  this_comm->src_data  = data;
 
   /* Look for communication synchro matching our needs. We also provide a description of
    * ourself so that the other side also gets a chance of choosing if it wants to match with us.
@@ -186,6 +175,9 @@ SIMIX_comm_irecv(smx_actor_t dst_proc, smx_mailbox_t mbox, void* dst_buff, size_
   simgrid::kernel::activity::CommImplPtr this_synchro =
       simgrid::kernel::activity::CommImplPtr(new simgrid::kernel::activity::CommImpl(SIMIX_COMM_RECEIVE));
   XBT_DEBUG("recv from mbox %p. this_synchro=%p", mbox, this_synchro.get());
+  /* The mailbox uses them to index our communication if it gets queued */
+  this_synchro->match_fun = match_fun;
+  this_synchro->dst_data  = data;
 
   simgrid::kernel::activity::CommImplPtr other_comm;
   //communication already done, get it inside the list of completed comms
@@ -432,6 +424,8 @@ void simcall_HANDLER_comm_waitany(smx_simcall_t simcall, xbt_dynar_t synchros, d
 
 void SIMIX_waitany_remove_simcall_from_actions(smx_simcall_t simcall)
 {
+  /* The dynar may be a local variable of the issuer */
+  simcall->issuer->context->load_stack();
   unsigned int cursor = 0;
   xbt_dynar_t synchros = simcall_comm_waitany__get__comms(simcall);
 
@@ -597,6 +591,7 @@ void SIMIX_comm_finish(smx_activity_t synchro)
       }
       catch(xbt_ex& e) {
         if (simcall->call == SIMCALL_COMM_WAITANY) {
+          simcall->issuer->context->load_stack();
           e.value = xbt_dynar_search(simcall_comm_waitany__get__comms(simcall), &synchro);
         }
         else if (simcall->call == SIMCALL_COMM_TESTANY) {
@@ -691,6 +686,19 @@ void SIMIX_comm_copy_data(smx_activity_t synchro)
             comm->src_proc ? comm->src_proc->host->get_cname() : "a finished process", comm->src_buff,
             comm->dst_proc ? comm->dst_proc->host->get_cname() : "a finished process", comm->dst_buff, buff_size);
 
+  /* The buffers may be local variables of the suspended actors. If they share their stack, the source data must be
+   * copied away before the stack of the receiver is loaded. */
+  void* src_buff = comm->src_buff;
+  std::vector<char> src_copy;
+  if (comm->src_proc)
+    comm->src_proc->context->load_stack();
+  if (comm->dst_proc && comm->dst_proc != comm->src_proc && comm->dst_proc->context->stack_overlaps(src_buff)) {
+    src_copy.assign(static_cast<char*>(src_buff), static_cast<char*>(src_buff) + buff_size);
+    src_buff = src_copy.data();
+  }
+  if (comm->dst_proc)
+    comm->dst_proc->context->load_stack();
+
   /* Copy at most dst_buff_size bytes of the message to receiver's buffer */
   if (comm->dst_buff_size)
     buff_size = std::min(buff_size, *(comm->dst_buff_size));
@@ -701,9 +709,9 @@ void SIMIX_comm_copy_data(smx_activity_t synchro)
 
   if (buff_size > 0){
       if(comm->copy_data_fun)
-        comm->copy_data_fun (comm, comm->src_buff, buff_size);
+        comm->copy_data_fun (comm, src_buff, buff_size);
       else
-        SIMIX_comm_copy_data_callback (comm, comm->src_buff, buff_size);
+        SIMIX_comm_copy_data_callback (comm, src_buff, buff_size);
   }
 
   /* Set the copied flag so we copy data only once */
@@ -24,6 +24,8 @@ class Global {
 public:
   smx_context_factory_t context_factory = nullptr;
   std::vector<smx_actor_t> process_to_run;
+  /* incremented each time process_to_run is emptied, so that an actor knows whether it is already in there */
+  unsigned long process_to_run_round = 1;
   std::vector<smx_actor_t> process_that_ran;
   std::map<aid_t, smx_actor_t> process_list;
   boost::intrusive::list<kernel::actor::ActorImpl,
@@ -64,6 +66,13 @@ public:
 }
 }
 
+namespace simgrid {
+namespace simix {
+/* Set while the simcalls are handled in parallel: the answered issuers are then rescheduled by the caller, in order */
+extern XBT_THREAD_LOCAL bool answers_deferred;
+}
+}
+
 XBT_PUBLIC_DATA std::unique_ptr<simgrid::simix::Global> simix_global;
 
 XBT_PUBLIC void SIMIX_clean();
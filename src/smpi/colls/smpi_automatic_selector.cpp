@@ -4,11 +4,133 @@
 /* This program is free software; you can redistribute it and/or modify it
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
+#include <boost/tokenizer.hpp>
 #include <cfloat>
+#include <cstdint>
+#include <cstdio>
 #include <exception>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
 
 #include "colls_private.hpp"
+#include "simgrid/s4u/Engine.hpp"
+#include "simgrid/s4u/Host.hpp"
+#include "simgrid/s4u/Link.hpp"
+#include "simgrid/modelchecker.h"
+#include "simgrid/simix.hpp"
 #include "smpi_process.hpp"
+#include "xbt/config.hpp"
+
+static simgrid::config::Flag<std::string> choices_file{
+    "smpi/coll-selector-file",
+    "CSV file where the choices of the automatic collective selector are loaded from at startup, and saved to at exit",
+    ""};
+
+/* The choices are indexed by "collective,communicator size,message size bucket" */
+static std::string platform_signature;
+static std::map<std::string, std::string> loaded_choices; /* read from the file, for the current platform */
+static std::map<std::string, std::string> tuned_choices;  /* made during this simulation */
+static std::vector<std::string> other_platforms_choices;  /* lines of the file that are kept as is */
+
+/** @brief Index of the power of 2 just above the size of the messages: the calls of similar sizes share their choice */
+static int size_bucket(size_t size)
+{
+  int bucket = 0;
+  for (; size > 0; size >>= 1)
+    bucket++;
+  return bucket;
+}
+
+/* The sizes have to be computed from arguments that are the same on all the ranks, so that all the ranks of a
+ * communicator look for the same choice. */
+static size_t message_size_gather(void* send_buff, int send_count, MPI_Datatype send_type, void*, int recv_count,
+                                  MPI_Datatype recv_type, int, MPI_Comm)
+{
+  return send_buff == MPI_IN_PLACE ? recv_count * recv_type->size() : send_count * send_type->size();
+}
+static size_t message_size_allgather(void*, int, MPI_Datatype, void*, int recv_count, MPI_Datatype recv_type, MPI_Comm)
+{
+  return recv_count * recv_type->size();
+}
+static size_t message_size_allgatherv(void*, int, MPI_Datatype, void*, int* recv_count, int*, MPI_Datatype recv_type,
+                                      MPI_Comm comm)
+{
+  size_t count = 0;
+  for (int i = 0; i < comm->size(); i++)
+    count += recv_count[i];
+  return count * recv_type->size();
+}
+static size_t message_size_alltoall(void*, int, MPI_Datatype, void*, int recv_count, MPI_Datatype recv_type, MPI_Comm)
+{
+  return recv_count * recv_type->size();
+}
+static size_t message_size_alltoallv(void*, int*, int*, MPI_Datatype, void*, int*, int*, MPI_Datatype, MPI_Comm)
+{
+  return 0; // The amounts differ from one rank to the other: all the calls share the same choice
+}
+static size_t message_size_bcast(void*, int count, MPI_Datatype datatype, int, MPI_Comm)
+{
+  return count * datatype->size();
+}
+static size_t message_size_reduce(void*, void*, int count, MPI_Datatype datatype, MPI_Op, int, MPI_Comm)
+{
+  return count * datatype->size();
+}
+static size_t message_size_allreduce(void*, void*, int rcount, MPI_Datatype dtype, MPI_Op, MPI_Comm)
+{
+  return rcount * dtype->size();
+}
+static size_t message_size_reduce_scatter(void*, void*, int* rcounts, MPI_Datatype dtype, MPI_Op, MPI_Comm comm)
+{
+  size_t count = 0;
+  for (int i = 0; i < comm->size(); i++)
+    count += rcounts[i];
+  return count * dtype->size();
+}
+static size_t message_size_scatter(void*, int sendcount, MPI_Datatype sendtype, void* recvbuf, int recvcount,
+                                   MPI_Datatype recvtype, int, MPI_Comm)
+{
+  return recvbuf == MPI_IN_PLACE ? sendcount * sendtype->size() : recvcount * recvtype->size();
+}
+static size_t message_size_barrier(MPI_Comm)
+{
+  return 0;
+}
+
+/** @brief Returns the algorithm to use for this call, or -1 if the algorithms have to be benched
+ *
+ * The choices made during the simulation are only reused on the communicator where they were made: a rank knows that
+ * all the other ranks of the communicator went through the same benchmarks. The choices loaded from the file are the
+ * same for everyone, and are used on all the communicators.
+ */
+static int automatic_choice(const char* cat, simgrid::smpi::s_mpi_coll_description_t* table, MPI_Comm comm, int bucket)
+{
+  std::string key = std::string(cat) + "," + std::to_string(bucket);
+  int coll        = comm->coll_choice(key);
+  if (coll != -1)
+    return coll;
+  auto it = loaded_choices.find(std::string(cat) + "," + std::to_string(comm->size()) + "," + std::to_string(bucket));
+  if (it == loaded_choices.end())
+    return -1;
+  for (coll = 0; table[coll].name; coll++)
+    if (it->second == table[coll].name) {
+      simgrid::simix::simcall([comm, key, coll] { comm->set_coll_choice(key, coll); });
+      return coll;
+    }
+  xbt_die("Collective '%s' is invalid for %s in %s", it->second.c_str(), cat, choices_file.get().c_str());
+}
+
+static void automatic_record(const char* cat, simgrid::smpi::s_mpi_coll_description_t* table, MPI_Comm comm,
+                             int bucket, int coll)
+{
+  simgrid::simix::simcall([cat, table, comm, bucket, coll] {
+    comm->set_coll_choice(std::string(cat) + "," + std::to_string(bucket), coll);
+    tuned_choices.emplace(std::string(cat) + "," + std::to_string(comm->size()) + "," + std::to_string(bucket),
+                          table[coll].name);
+  });
+}
 
 //attempt to do a quick autotuning version of the collective,
 #define TRACE_AUTO_COLL(cat)                                                                                           \
@@ -25,9 +147,14 @@
 #define AUTOMATIC_COLL_BENCH(cat, ret, args, args2)                                                                    \
   ret Coll_##cat##_automatic::cat(COLL_UNPAREN args)                                                                   \
   {                                                                                                                    \
+    int bucket = size_bucket(message_size_##cat args2);                                                                \
+    int i      = automatic_choice(#cat, Colls::mpi_coll_##cat##_description, comm, bucket);                            \
+    if (i != -1) {                                                                                                     \
+      TRACE_AUTO_COLL(cat)                                                                                             \
+      return ((int(*) args)Colls::mpi_coll_##cat##_description[i].coll) args2;                                         \
+    }                                                                                                                  \
     double time1, time2, time_min = DBL_MAX;                                                                           \
     int min_coll = -1, global_coll = -1;                                                                               \
-    int i;                                                                                                             \
     double buf_in, buf_out, max_min = DBL_MAX;                                                                         \
     for (i = 0; Colls::mpi_coll_##cat##_description[i].name; i++) {                                                    \
       if (not strcmp(Colls::mpi_coll_##cat##_description[i].name, "automatic"))                                        \
@@ -63,7 +190,12 @@
     } else                                                                                                             \
       XBT_WARN("The quickest %s was %s on rank %d and took %f", #cat,                                                  \
                Colls::mpi_coll_##cat##_description[min_coll].name, comm->rank(), time_min);                            \
-    return (min_coll != -1) ? MPI_SUCCESS : MPI_ERR_INTERN;                                                            \
+    /* The next calls of similar size use the algorithm that was the quickest on the slowest rank */                   \
+    Coll_bcast_default::bcast(&global_coll, 1, MPI_INT, 0, comm);                                                      \
+    if (global_coll == -1)                                                                                             \
+      return MPI_ERR_INTERN;                                                                                           \
+    automatic_record(#cat, Colls::mpi_coll_##cat##_description, comm, bucket, global_coll);                            \
+    return MPI_SUCCESS;                                                                                                \
   }
 
 namespace simgrid{
@@ -83,3 +215,79 @@ COLL_APPLY(AUTOMATIC_COLL_BENCH, COLL_BARRIER_SIG,(comm));
 
 }
 }
+
+static std::string compute_platform_signature()
+{
+  /* All the digits of the values are needed: std::to_string would for example make all latencies below 1e-6 equal */
+  auto exact = [](double value) {
+    char buff[32];
+    snprintf(buff, sizeof buff, "%.17g", value);
+    return std::string(buff);
+  };
+  std::string desc;
+  for (auto const& host : simgrid::s4u::Engine::get_instance()->get_all_hosts())
+    desc += std::string(host->get_cname()) + ":" + exact(host->getSpeed()) + ";";
+  for (auto const& link : simgrid::s4u::Engine::get_instance()->get_all_links())
+    desc +=
+        std::string(link->get_cname()) + ":" + exact(link->get_bandwidth()) + ":" + exact(link->get_latency()) + ";";
+  /* The signature is saved in the choices file: hash it with a fixed algorithm (64-bit FNV-1a), and not with
+   * std::hash, whose result depends on the standard library */
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : desc) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream oss;
+  oss << std::hex << std::setfill('0') << std::setw(16) << hash;
+  return oss.str();
+}
+
+/** @brief Loads the choices of smpi/coll-selector-file that were made on the same platform */
+void smpi_coll_choices_init()
+{
+  if (choices_file.get().empty())
+    return;
+  platform_signature = compute_platform_signature();
+  std::ifstream fstream(choices_file.get());
+  if (not fstream.is_open()) {
+    XBT_VERB("No choice of the automatic collective selector in %s yet", choices_file.get().c_str());
+    return;
+  }
+
+  std::string line;
+  typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
+  std::getline(fstream, line); // Skip the header line
+  while (std::getline(fstream, line)) {
+    Tokenizer tok(line);
+    std::vector<std::string> fields(tok.begin(), tok.end());
+    xbt_assert(fields.size() == 5, "Invalid line in %s: %s", choices_file.get().c_str(), line.c_str());
+    if (fields[0] != platform_signature)
+      other_platforms_choices.push_back(line);
+    else
+      loaded_choices.emplace(fields[1] + "," + fields[2] + "," + fields[3], fields[4]);
+  }
+  XBT_VERB("Loaded %zu choices of the automatic collective selector from %s", loaded_choices.size(),
+           choices_file.get().c_str());
+}
+
+/** @brief Saves the choices to smpi/coll-selector-file, along with the ones of the other platforms */
+void smpi_coll_choices_destroy()
+{
+  if (not choices_file.get().empty() && not tuned_choices.empty() && not MC_is_active()) {
+    std::string tmp_file = choices_file.get() + ".tmp";
+    std::ofstream fstream(tmp_file);
+    for (auto const& elm : loaded_choices)
+      tuned_choices.insert(elm);
+    fstream << "platform,collective,comm_size,size_bucket,algorithm\n";
+    for (auto const& line : other_platforms_choices)
+      fstream << line << '\n';
+    for (auto const& elm : tuned_choices)
+      fstream << platform_signature << ',' << elm.first << ',' << elm.second << '\n';
+    fstream.close();
+    if (fstream.fail() || std::rename(tmp_file.c_str(), choices_file.get().c_str()) != 0)
+      XBT_WARN("Cannot save the choices of the automatic collective selector to %s", choices_file.get().c_str());
+  }
+  loaded_choices.clear();
+  tuned_choices.clear();
+  other_platforms_choices.clear();
+}
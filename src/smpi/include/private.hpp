@@ -98,11 +98,24 @@ XBT_PRIVATE int smpi_is_privatization_file(char* file);
 XBT_PRIVATE void smpi_prepare_global_memory_segment();
 XBT_PRIVATE void smpi_backup_global_memory_segment();
 XBT_PRIVATE void smpi_destroy_global_memory_segments();
+XBT_PRIVATE void smpi_bench_init();
+XBT_PRIVATE void smpi_coll_choices_init();
+XBT_PRIVATE void smpi_coll_choices_destroy();
 XBT_PRIVATE void smpi_bench_destroy();
 XBT_PRIVATE void smpi_bench_begin();
 XBT_PRIVATE void smpi_bench_end();
 XBT_PRIVATE void smpi_shared_destroy();
 
+/* Variants of the functions of smpi.h filling a given vector, so that the callers can reuse its storage */
+XBT_PRIVATE void shift_and_frame_private_blocks(const std::vector<std::pair<size_t, size_t>>& vec, size_t offset,
+                                                size_t buff_size, std::vector<std::pair<size_t, size_t>>& result);
+XBT_PRIVATE void merge_private_blocks(const std::vector<std::pair<size_t, size_t>>& src,
+                                      const std::vector<std::pair<size_t, size_t>>& dst,
+                                      std::vector<std::pair<size_t, size_t>>& result);
+
+XBT_PRIVATE void* smpi_detached_buffer_new(const void* data, size_t size, void (**free_fun)(void*));
+XBT_PRIVATE void smpi_zero_copy_buffer_free(void* buff);
+
 XBT_PRIVATE void* smpi_get_tmp_sendbuffer(int size);
 XBT_PRIVATE void* smpi_get_tmp_recvbuffer(int size);
 XBT_PRIVATE void smpi_free_tmp_buffer(void* buf);
@@ -7,6 +7,8 @@
 #define SMPI_COMM_HPP_INCLUDED
 
 #include <list>
+#include <string>
+#include <unordered_map>
 #include "smpi_keyvals.hpp"
 #include "smpi_group.hpp"
 #include "smpi_topo.hpp"
@@ -30,6 +32,7 @@ class Comm : public F2C, public Keyval{
     int is_blocked_;// are ranks allocated on the same smp node contiguous ?
 
     std::list<MPI_Win> rma_wins_; // attached windows for synchronization.
+    std::unordered_map<std::string, int> coll_choices_; // algorithms picked by the automatic selector on this comm
 
   public:
     static std::unordered_map<int, smpi_key_elem> keyvals_;
@@ -69,6 +72,8 @@ class Comm : public F2C, public Keyval{
     void add_rma_win(MPI_Win win);
     void remove_rma_win(MPI_Win win);
     void finish_rma_calls();
+    int coll_choice(const std::string& key);
+    void set_coll_choice(const std::string& key, int coll);
     MPI_Comm split_type(int type, int key, MPI_Info info);
 
 };
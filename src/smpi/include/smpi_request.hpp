@@ -93,6 +93,7 @@ class Request : public F2C {
 
     static int match_send(void* a, void* b, simgrid::kernel::activity::CommImpl* ignored);
     static int match_recv(void* a, void* b, simgrid::kernel::activity::CommImpl* ignored);
+    static bool match_descriptor(void* a, simgrid::kernel::activity::MatchDescriptor* descriptor);
 
     int add_f() override;
     static void free_f(int id);
@@ -14,6 +14,10 @@
 #include "xbt/config.hpp"
 #include "getopt.h"
 
+#include <algorithm>
+#include <boost/tokenizer.hpp>
+#include <cstdio>
+#include <fstream>
 #include <unordered_map>
 
 #ifndef WIN32
@@ -271,6 +275,13 @@ unsigned long long smpi_rastro_timestamp ()
 }
 
 /* ****************************** Functions related to the SMPI_SAMPLE_ macros ************************************/
+static simgrid::config::Flag<std::string> sample_file{
+    "smpi/sample-file",
+    "CSV file where the measurements of the SMPI_SAMPLE blocks are loaded from at startup, and saved to at exit", ""};
+static simgrid::config::Flag<std::string> sample_signature{
+    "smpi/sample-signature",
+    "Signature of the input of the application, the measurements in smpi/sample-file being specific to it", ""};
+
 namespace {
 class SampleLocation : public std::string {
 public:
@@ -279,6 +290,7 @@ public:
     if (not global)
       this->append(":" + std::to_string(simgrid::s4u::this_actor::get_pid()));
   }
+  explicit SampleLocation(const std::string& location) : std::string(location) {}
 };
 
 class LocalData {
@@ -291,8 +303,10 @@ public:
   int iters;        /* amount of requested iterations */
   int count;        /* amount of iterations done so far */
   bool benching;    /* true: we are benchmarking; false: we have enough data, no bench anymore */
+  bool loaded;      /* true: the first measurements come from smpi/sample-file */
 
   bool need_more_benchs() const;
+  void update_stats();
 };
 
 bool LocalData::need_more_benchs() const
@@ -305,7 +319,95 @@ bool LocalData::need_more_benchs() const
   return res;
 }
 
+/** Computes the mean and the relative standard error from count, sum and sum_pow2 */
+void LocalData::update_stats()
+{
+  double n  = static_cast<double>(count);
+  mean      = sum / n;
+  relstderr = sqrt((sum_pow2 / n - mean * mean) / n) / mean;
+}
+
 std::unordered_map<SampleLocation, LocalData, std::hash<std::string>> samples;
+std::vector<std::string> other_signatures_samples; /* lines of smpi/sample-file that are kept as is */
+}
+
+static std::string quote_csv(const std::string& str)
+{
+  std::string res = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      res += '\\';
+    res += c;
+  }
+  return res + "\"";
+}
+
+/** @brief Loads the measurements of smpi/sample-file that match smpi/sample-signature */
+void smpi_bench_init()
+{
+  if (sample_file.get().empty())
+    return;
+  std::ifstream fstream(sample_file.get());
+  if (not fstream.is_open()) {
+    XBT_VERB("No measurement of the SMPI_SAMPLE blocks in %s yet", sample_file.get().c_str());
+    return;
+  }
+
+  std::string line;
+  typedef boost::tokenizer<boost::escaped_list_separator<char>> Tokenizer;
+  std::getline(fstream, line); // Skip the header line
+  while (std::getline(fstream, line)) {
+    Tokenizer tok(line);
+    std::vector<std::string> fields(tok.begin(), tok.end());
+    xbt_assert(fields.size() == 7, "Invalid line in %s: %s", sample_file.get().c_str(), line.c_str());
+    if (fields[0] != sample_signature.get()) {
+      other_signatures_samples.push_back(line);
+      continue;
+    }
+    LocalData data{std::stod(fields[3]), // threshold
+                   0.0,                  // relstderr
+                   0.0,                  // mean
+                   std::stod(fields[5]), // sum
+                   std::stod(fields[6]), // sum_pow2
+                   std::stoi(fields[2]), // iters
+                   std::stoi(fields[4]), // count
+                   false,                // benching
+                   true};                // loaded
+    data.update_stats();
+    samples.emplace(SampleLocation(fields[1]), data);
+  }
+  XBT_VERB("Loaded the measurements of %zu SMPI_SAMPLE blocks from %s", samples.size(), sample_file.get().c_str());
+}
+
+/** @brief Saves the measurements to smpi/sample-file, along with the ones of the other signatures */
+static void smpi_bench_save()
+{
+  std::string tmp_file = sample_file.get() + ".tmp";
+  std::ofstream fstream(tmp_file);
+  if (not fstream.is_open()) {
+    XBT_WARN("Cannot save the measurements of the SMPI_SAMPLE blocks to %s", tmp_file.c_str());
+    return;
+  }
+
+  std::vector<std::pair<std::string, const LocalData*>> sorted;
+  for (auto const& elm : samples)
+    if (elm.second.count > 0)
+      sorted.emplace_back(elm.first, &elm.second);
+  std::sort(begin(sorted), end(sorted));
+
+  fstream.precision(17);
+  fstream << "signature,location,iterations,threshold,count,sum,sum_pow2\n";
+  for (auto const& line : other_signatures_samples)
+    fstream << line << '\n';
+  for (auto const& elm : sorted)
+    fstream << quote_csv(sample_signature.get()) << ',' << quote_csv(elm.first) << ',' << elm.second->iters << ','
+            << elm.second->threshold << ',' << elm.second->count << ',' << elm.second->sum << ','
+            << elm.second->sum_pow2 << '\n';
+  fstream.close();
+  if (fstream.fail() || std::rename(tmp_file.c_str(), sample_file.get().c_str()) != 0)
+    XBT_WARN("Cannot save the measurements of the SMPI_SAMPLE blocks to %s", sample_file.get().c_str());
+  else
+    XBT_VERB("Saved the measurements of %zu SMPI_SAMPLE blocks to %s", sorted.size(), sample_file.get().c_str());
 }
 
 void smpi_sample_1(int global, const char *file, int line, int iters, double threshold)
@@ -323,7 +425,8 @@ void smpi_sample_1(int global, const char *file, int line, int iters, double thr
                                          0.0,       // sum_pow2
                                          iters,     // iters
                                          0,         // count
-                                         true       // benching (if we have no data, we need at least one)
+                                         true,      // benching (if we have no data, we need at least one)
+                                         false      // loaded
                                      });
   LocalData& data = insert.first->second;
   if (insert.second) {
@@ -331,7 +434,12 @@ void smpi_sample_1(int global, const char *file, int line, int iters, double thr
     xbt_assert(threshold > 0 || iters > 0,
         "You should provide either a positive amount of iterations to bench, or a positive maximal stderr (or both)");
   } else {
-    if (data.iters != iters || data.threshold != threshold) {
+    if (data.loaded && (data.iters != iters || data.threshold != threshold)) {
+      XBT_VERB("The block %s is now benched with settings %d, %f instead of %d, %f", loc.c_str(), iters, threshold,
+               data.iters, data.threshold);
+      data.iters     = iters;
+      data.threshold = threshold;
+    } else if (data.iters != iters || data.threshold != threshold) {
       XBT_ERROR("Asked to bench block %s with different settings %d, %f is not %d, %f. "
                 "How did you manage to give two numbers at the same line??",
                 loc.c_str(), data.iters, data.threshold, iters, threshold);
@@ -397,9 +505,7 @@ void smpi_sample_3(int global, const char *file, int line)
   double period  = xbt_os_timer_elapsed(smpi_process()->timer());
   data.sum      += period;
   data.sum_pow2 += period * period;
-  double n       = static_cast<double>(data.count);
-  data.mean      = data.sum / n;
-  data.relstderr = sqrt((data.sum_pow2 / n - data.mean * data.mean) / n) / data.mean;
+  data.update_stats();
   if (data.need_more_benchs()) {
     data.mean = period; // Still in benching process; We want sample_2 to simulate the exact time of this loop
     // occurrence before leaving, not the mean over the history
@@ -440,7 +546,10 @@ void smpi_trace_set_call_location__(const char* file, int* line)
 
 void smpi_bench_destroy()
 {
+  if (not sample_file.get().empty() && not MC_is_active())
+    smpi_bench_save();
   samples.clear();
+  other_signatures_samples.clear();
 }
 
 int smpi_getopt_long (int argc,  char *const *argv,  const char *options,
@@ -8,6 +8,8 @@
 #include "simgrid/s4u/Engine.hpp"
 #include "smpi_coll.hpp"
 #include "smpi_process.hpp"
+#include "smpi_request.hpp"
+#include "src/kernel/activity/MailboxImpl.hpp"
 #include "src/msg/msg_private.hpp"
 #include "src/simix/smx_private.hpp"
 #include "xbt/config.hpp"
@@ -16,6 +18,7 @@
 #include <dlfcn.h>
 #include <fcntl.h>
 #include <fstream>
+#include <sys/mman.h>
 
 #if HAVE_SENDFILE
 #include <sys/sendfile.h>
@@ -74,6 +77,10 @@ static simgrid::config::Flag<double> smpi_wtime_sleep(
   "smpi/wtime", "Minimum time to inject inside a call to MPI_Wtime", 0.0);
 static simgrid::config::Flag<double> smpi_init_sleep(
   "smpi/init", "Time to inject inside a call to MPI_Init", 0.0);
+static simgrid::config::Flag<int> smpi_zero_copy_thresh(
+    "smpi/zero-copy-thresh",
+    "Minimal size of the detached messages whose memory pages are moved to the receiver instead of copied (0: never)",
+    0);
 
 void (*smpi_comm_copy_data_callback) (smx_activity_t, void*, size_t) = &smpi_comm_copy_buffer_callback;
 
@@ -148,65 +155,170 @@ static void check_blocks(std::vector<std::pair<size_t, size_t>> &private_blocks,
     xbt_assert(block.first <= block.second && block.second <= buff_size, "Oops, bug in shared malloc.");
 }
 
-void smpi_comm_copy_buffer_callback(smx_activity_t synchro, void *buff, size_t buff_size)
+/** @brief Bookkeeping of a zero-copy buffer, in the first page of its mapping */
+struct ZeroCopyHeader {
+  size_t length;      /* length of the whole mapping */
+  size_t moved_begin; /* range of pages that were moved to a receive buffer (offsets in the mapping), if any */
+  size_t moved_end;
+};
+
+static ZeroCopyHeader* zero_copy_header(void* buff)
 {
-  simgrid::kernel::activity::CommImplPtr comm =
-      boost::dynamic_pointer_cast<simgrid::kernel::activity::CommImpl>(synchro);
-  int src_shared                        = 0;
-  int dst_shared                        = 0;
-  size_t src_offset                     = 0;
-  size_t dst_offset                     = 0;
-  std::vector<std::pair<size_t, size_t>> src_private_blocks;
-  std::vector<std::pair<size_t, size_t>> dst_private_blocks;
-  XBT_DEBUG("Copy the data over");
-  if((src_shared=smpi_is_shared(buff, src_private_blocks, &src_offset))) {
-    XBT_DEBUG("Sender %p is shared. Let's ignore it.", buff);
-    src_private_blocks = shift_and_frame_private_blocks(src_private_blocks, src_offset, buff_size);
-  }
-  else {
-    src_private_blocks.clear();
-    src_private_blocks.push_back(std::make_pair(0, buff_size));
+  return reinterpret_cast<ZeroCopyHeader*>(static_cast<char*>(TOPAGE(buff)) - xbt_pagesize);
+}
+
+/** @brief Allocates the buffer of a detached send, holding a copy of the size bytes of data
+ *
+ * From smpi/zero-copy-thresh bytes, the buffer gets its own pages, and starts at the same offset in its page as data.
+ * Given that the large buffers returned by malloc are all at the same offset in their first page, the full pages of
+ * the message can then often be moved to the receive buffer with mremap (see smpi_comm_copy_buffer_callback).
+ * The buffer must be released with the function returned in free_fun.
+ */
+void* smpi_detached_buffer_new(const void* data, size_t size, void (**free_fun)(void*))
+{
+  void* buff;
+#ifdef MREMAP_FIXED
+  if (smpi_zero_copy_thresh > 0 && size >= static_cast<size_t>(smpi_zero_copy_thresh) && not MC_is_active()) {
+    /* The first page holds the bookkeeping of the mapping, the data starts in the next one */
+    size_t offset = reinterpret_cast<uintptr_t>(data) % xbt_pagesize;
+    size_t length = xbt_pagesize + (offset + size + xbt_pagesize - 1) / xbt_pagesize * xbt_pagesize;
+    void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping != MAP_FAILED) {
+      *static_cast<ZeroCopyHeader*>(mapping) = {length, 0, 0};
+      buff                                   = static_cast<char*>(mapping) + xbt_pagesize + offset;
+      memcpy(buff, data, size);
+      *free_fun = &smpi_zero_copy_buffer_free;
+      return buff;
+    }
   }
-  if((dst_shared=smpi_is_shared((char*)comm->dst_buff, dst_private_blocks, &dst_offset))) {
-    XBT_DEBUG("Receiver %p is shared. Let's ignore it.", (char*)comm->dst_buff);
-    dst_private_blocks = shift_and_frame_private_blocks(dst_private_blocks, dst_offset, buff_size);
+#endif
+  buff = xbt_malloc(size);
+  memcpy(buff, data, size);
+  *free_fun = &xbt_free_f;
+  return buff;
+}
+
+void smpi_zero_copy_buffer_free(void* buff)
+{
+  ZeroCopyHeader* header = zero_copy_header(buff);
+  char* mapping          = reinterpret_cast<char*>(header);
+  size_t length          = header->length;
+  if (header->moved_begin == header->moved_end) {
+    munmap(mapping, length);
+  } else {
+    /* The moved pages left a hole in the mapping, where another thread may have mapped something since then */
+    size_t moved_end = header->moved_end;
+    munmap(mapping, header->moved_begin);
+    if (moved_end < length)
+      munmap(mapping + moved_end, length - moved_end);
   }
-  else {
-    dst_private_blocks.clear();
-    dst_private_blocks.push_back(std::make_pair(0, buff_size));
+}
+
+/** @brief Moves the full pages of a zero-copy buffer to dst instead of copying them, when they are at the same offset
+ *
+ * The pages of the receive buffer are replaced by the pages of the message, so they must be private anonymous memory.
+ * This excludes the shared mallocs and the privatized data segment, that are not passed here. Falls back to memcpy on
+ * error, for instance when the process reaches its maximal number of memory mappings.
+ */
+static void move_zero_copy_buffer(char* dst, char* src, size_t size)
+{
+#ifdef MREMAP_FIXED
+  uintptr_t offset = reinterpret_cast<uintptr_t>(dst) % xbt_pagesize;
+  char* first      = dst + (offset == 0 ? 0 : xbt_pagesize - offset);
+  char* last       = static_cast<char*>(TOPAGE(dst + size));
+  if (reinterpret_cast<uintptr_t>(src) % xbt_pagesize == offset && first < last) {
+    memcpy(dst, src, first - dst);
+    memcpy(last, src + (last - dst), dst + size - last);
+    if (mremap(src + (first - dst), last - first, last - first, MREMAP_MAYMOVE | MREMAP_FIXED, first) != MAP_FAILED) {
+      ZeroCopyHeader* header = zero_copy_header(src);
+      header->moved_begin    = src + (first - dst) - reinterpret_cast<char*>(header);
+      header->moved_end      = header->moved_begin + (last - first);
+      XBT_DEBUG("Moved %zu bytes of pages from %p to %p", static_cast<size_t>(last - first), src + (first - dst),
+                first);
+      return;
+    }
+    XBT_DEBUG("Cannot move the pages of the message (%s), copy them", strerror(errno));
+    memcpy(first, src + (first - dst), last - first);
+    return;
   }
-  check_blocks(src_private_blocks, buff_size);
-  check_blocks(dst_private_blocks, buff_size);
-  auto private_blocks = merge_private_blocks(src_private_blocks, dst_private_blocks);
-  check_blocks(private_blocks, buff_size);
-  void* tmpbuff=buff;
-  if ((smpi_privatize_global_variables == SmpiPrivStrategies::MMAP) &&
-      (static_cast<char*>(buff) >= smpi_data_exe_start) &&
-      (static_cast<char*>(buff) < smpi_data_exe_start + smpi_data_exe_size)) {
-    XBT_DEBUG("Privatization : We are copying from a zone inside global memory... Saving data to temp buffer !");
-    smpi_switch_data_segment(comm->src_proc->iface());
-    tmpbuff = static_cast<void*>(xbt_malloc(buff_size));
-    memcpy_private(tmpbuff, buff, private_blocks);
+#endif
+  memcpy(dst, src, size);
+}
+
+/** @brief Address of the copy of ptr that belongs to the given actor, when ptr is in the privatized data segment
+ *
+ * The data segment of each actor stays mapped at its own address, where it can be read or written without mapping it
+ * over the global one.
+ */
+static char* smpi_actor_address(ActorPtr actor, void* ptr)
+{
+  char* addr = static_cast<char*>(ptr);
+  if (smpi_privatize_global_variables == SmpiPrivStrategies::MMAP && addr >= smpi_data_exe_start &&
+      addr < smpi_data_exe_start + smpi_data_exe_size) {
+    smpi_privatization_region_t region = smpi_process_remote(actor)->privatized_region();
+    xbt_assert(region != nullptr, "The data segment of actor %ld is not privatized yet", actor->get_pid());
+    return static_cast<char*>(region->address) + (addr - static_cast<char*>(TOPAGE(smpi_data_exe_start)));
   }
+  return addr;
+}
 
-  if ((smpi_privatize_global_variables == SmpiPrivStrategies::MMAP) && ((char*)comm->dst_buff >= smpi_data_exe_start) &&
-      ((char*)comm->dst_buff < smpi_data_exe_start + smpi_data_exe_size)) {
-    XBT_DEBUG("Privatization : We are copying to a zone inside global memory - Switch data segment");
-    smpi_switch_data_segment(comm->dst_proc->iface());
+void smpi_comm_copy_buffer_callback(smx_activity_t synchro, void *buff, size_t buff_size)
+{
+  simgrid::kernel::activity::CommImplPtr comm =
+      boost::dynamic_pointer_cast<simgrid::kernel::activity::CommImpl>(synchro);
+  /* Reused from one message to the next, so that copying the messages does not allocate memory */
+  static std::vector<std::pair<size_t, size_t>> src_private_blocks;
+  static std::vector<std::pair<size_t, size_t>> dst_private_blocks;
+  static std::vector<std::pair<size_t, size_t>> private_blocks;
+  size_t src_offset = 0;
+  size_t dst_offset = 0;
+  bool zero_copy    = comm->detached && comm->clean_fun == &smpi_zero_copy_buffer_free;
+  XBT_DEBUG("Copy the data over");
+  char* src = smpi_actor_address(comm->src_proc->iface(), buff);
+  char* dst = smpi_actor_address(comm->dst_proc->iface(), comm->dst_buff);
+  int src_shared = smpi_is_shared(buff, src_private_blocks, &src_offset);
+  int dst_shared = smpi_is_shared(comm->dst_buff, dst_private_blocks, &dst_offset);
+
+  if (not src_shared && not dst_shared) {
+    XBT_DEBUG("Copying %zu bytes from %p to %p", buff_size, src, dst);
+    if (zero_copy && dst == comm->dst_buff)
+      move_zero_copy_buffer(dst, src, buff_size);
+    else
+      memcpy(dst, src, buff_size);
+  } else {
+    if (src_shared) {
+      XBT_DEBUG("Sender %p is shared. Let's ignore it.", buff);
+      shift_and_frame_private_blocks(src_private_blocks, src_offset, buff_size, private_blocks);
+      src_private_blocks.swap(private_blocks);
+    } else {
+      src_private_blocks.assign(1, std::make_pair(0, buff_size));
+    }
+    if (dst_shared) {
+      XBT_DEBUG("Receiver %p is shared. Let's ignore it.", (char*)comm->dst_buff);
+      shift_and_frame_private_blocks(dst_private_blocks, dst_offset, buff_size, private_blocks);
+      dst_private_blocks.swap(private_blocks);
+    } else {
+      dst_private_blocks.assign(1, std::make_pair(0, buff_size));
+    }
+    check_blocks(src_private_blocks, buff_size);
+    check_blocks(dst_private_blocks, buff_size);
+    merge_private_blocks(src_private_blocks, dst_private_blocks, private_blocks);
+    check_blocks(private_blocks, buff_size);
+    XBT_DEBUG("Copying the private blocks of %zu bytes from %p to %p", buff_size, src, dst);
+    memcpy_private(dst, src, private_blocks);
   }
-  XBT_DEBUG("Copying %zu bytes from %p to %p", buff_size, tmpbuff,comm->dst_buff);
-  memcpy_private(comm->dst_buff, tmpbuff, private_blocks);
 
   if (comm->detached) {
     // if this is a detached send, the source buffer was duplicated by SMPI
     // sender to make the original buffer available to the application ASAP
-    xbt_free(buff);
+    if (zero_copy)
+      smpi_zero_copy_buffer_free(buff);
+    else
+      xbt_free(buff);
     //It seems that the request is used after the call there this should be free somewhere else but where???
     //xbt_free(comm->comm.src_data);// inside SMPI the request is kept inside the user data and should be free
     comm->src_buff = nullptr;
   }
-  if (tmpbuff != buff)
-    xbt_free(tmpbuff);
 }
 
 void smpi_comm_null_copy_buffer_callback(smx_activity_t comm, void *buff, size_t buff_size)
@@ -221,6 +333,12 @@ static void smpi_check_options()
   xbt_assert(simgrid::config::get_value<int>("smpi/async-small-thresh") <=
              simgrid::config::get_value<int>("smpi/send-is-detached-thresh"));
 
+  if (smpi_zero_copy_thresh > 0 &&
+      smpi_zero_copy_thresh >= simgrid::config::get_value<int>("smpi/send-is-detached-thresh"))
+    XBT_WARN("No message will be moved by pages: only the detached messages can be, and smpi/zero-copy-thresh (%d) is "
+             "not below smpi/send-is-detached-thresh (%d).",
+             smpi_zero_copy_thresh.get(), simgrid::config::get_value<int>("smpi/send-is-detached-thresh"));
+
   if (simgrid::config::is_default("smpi/host-speed")) {
     XBT_INFO("You did not set the power of the host running the simulation.  "
              "The timings will certainly not be accurate.  "
@@ -244,6 +362,9 @@ void smpi_global_init()
     xbt_os_walltimer_start(global_timer);
   }
 
+  smpi_bench_init();
+  smpi_coll_choices_init();
+
   std::string filename = simgrid::config::get_value<std::string>("smpi/comp-adjustment-file");
   if (not filename.empty()) {
     std::ifstream fstream(filename);
@@ -337,6 +458,7 @@ void smpi_global_init()
 void smpi_global_destroy()
 {
   smpi_bench_destroy();
+  smpi_coll_choices_destroy();
   smpi_shared_destroy();
   smpi_deployment_cleanup_instances();
 
@@ -385,6 +507,11 @@ static void smpi_init_options(){
     smpi_privatize_global_variables = SmpiPrivStrategies::DLOPEN;
   }
 #endif
+  if (smpi_privatize_global_variables == SmpiPrivStrategies::MMAP && SIMIX_context_is_parallel()) {
+    /* The data segment is mapped for the whole process, so only one actor at a time can use its own segment */
+    XBT_INFO("mmap privatization cannot be used with parallel contexts, switching to dlopen privatization instead.");
+    smpi_privatize_global_variables = SmpiPrivStrategies::DLOPEN;
+  }
 
   if (smpi_cpu_threshold < 0)
     smpi_cpu_threshold = DBL_MAX;
@@ -472,6 +599,8 @@ int smpi_main(const char* executable, int argc, char *argv[])
   SIMIX_comm_set_copy_data_callback(smpi_comm_copy_buffer_callback);
 
   smpi_init_options();
+  if (smpi_privatize_global_variables != SmpiPrivStrategies::MMAP)
+    SMPI_switch_data_segment = nullptr; // No need to switch anything when the actors get scheduled
   if (smpi_privatize_global_variables == SmpiPrivStrategies::DLOPEN) {
 
     std::string executable_copy = executable;
@@ -483,12 +612,12 @@ int smpi_main(const char* executable, int argc, char *argv[])
     static std::size_t rank = 0;
 
     simix_global->default_function = [executable_copy, fdin_size](std::vector<std::string> args) {
-      return std::function<void()>([executable_copy, fdin_size, args] {
+      // Named by maestro, as the actors may start in parallel
+      std::string target_executable =
+          executable_copy + "_" + std::to_string(getpid()) + "_" + std::to_string(rank++) + ".so";
+      return std::function<void()>([executable_copy, fdin_size, target_executable, args] {
 
         // Copy the dynamic library:
-        std::string target_executable = executable_copy
-          + "_" + std::to_string(getpid())
-          + "_" + std::to_string(rank++) + ".so";
 
         int fdin = open(executable_copy.c_str(), O_RDONLY);
         xbt_assert(fdin >= 0, "Cannot read from %s. Please make sure that the file exists and is executable.",
@@ -612,6 +741,12 @@ void SMPI_init(){
     }
   });
 
+  /* Let the mailboxes index the pending messages by source and tag */
+  simgrid::kernel::activity::MailboxImpl::set_match_descriptor(&simgrid::smpi::Request::match_send,
+                                                               &simgrid::smpi::Request::match_descriptor);
+  simgrid::kernel::activity::MailboxImpl::set_match_descriptor(&simgrid::smpi::Request::match_recv,
+                                                               &simgrid::smpi::Request::match_descriptor);
+
   smpi_init_options();
   smpi_global_init();
   smpi_check_options();
@@ -5,6 +5,7 @@
 
 #include "smpi_process.hpp"
 #include "mc/mc.h"
+#include "simgrid/simix.hpp"
 #include "smpi_comm.hpp"
 #include "src/mc/mc_replay.hpp"
 #include "src/msg/msg_private.hpp"
@@ -245,16 +246,9 @@ void Process::init(int *argc, char ***argv){
     simgrid::s4u::ActorPtr proc = simgrid::s4u::Actor::self();
     proc->get_impl()->context->set_cleanup(&MSG_process_cleanup_from_SIMIX);
 
-    char* instance_id = (*argv)[1];
-    try {
-      int rank = std::stoi(std::string((*argv)[2]));
-      smpi_deployment_register_process(instance_id, rank, proc);
-    } catch (std::invalid_argument& ia) {
-      throw std::invalid_argument(std::string("Invalid rank: ") + (*argv)[2]);
-    }
-
     // cheinrich: I'm not sure what the impact of the SMPI_switch_data_segment on this call is. I moved
     // this up here so that I can set the privatized region before the switch.
+    // The region must be set before the simcall below, as the segment gets switched when the actor is scheduled back.
     Process* process = smpi_process_remote(proc);
     if (smpi_privatize_global_variables == SmpiPrivStrategies::MMAP) {
       /* Now using the segment index of this process  */
@@ -263,6 +257,15 @@ void Process::init(int *argc, char ***argv){
       SMPI_switch_data_segment(proc);
     }
 
+    char* instance_id = (*argv)[1];
+    try {
+      int rank = std::stoi(std::string((*argv)[2]));
+      // The ranks may be initialized in parallel, but the instance is shared: let maestro register them one at a time
+      simgrid::simix::simcall([instance_id, rank, proc] { smpi_deployment_register_process(instance_id, rank, proc); });
+    } catch (std::invalid_argument& ia) {
+      throw std::invalid_argument(std::string("Invalid rank: ") + (*argv)[2]);
+    }
+
     process->set_data(argc, argv);
   }
   xbt_assert(smpi_process(), "smpi_process() returned nullptr. You probably gave a nullptr parameter to MPI_Init. "
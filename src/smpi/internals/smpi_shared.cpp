@@ -377,23 +377,31 @@ int smpi_is_shared(void* ptr, std::vector<std::pair<size_t, size_t>> &private_bl
   }
 }
 
-std::vector<std::pair<size_t, size_t>> shift_and_frame_private_blocks(const std::vector<std::pair<size_t, size_t>>& vec,
-                                                                      size_t offset, size_t buff_size)
+void shift_and_frame_private_blocks(const std::vector<std::pair<size_t, size_t>>& vec, size_t offset,
+                                    size_t buff_size, std::vector<std::pair<size_t, size_t>>& result)
 {
-  std::vector<std::pair<size_t, size_t>> result;
+  result.clear();
   for (auto const& block : vec) {
     auto new_block = std::make_pair(std::min(std::max((size_t)0, block.first - offset), buff_size),
                                     std::min(std::max((size_t)0, block.second - offset), buff_size));
     if (new_block.second > 0 && new_block.first < buff_size)
       result.push_back(new_block);
   }
-  return result;
 }
 
-std::vector<std::pair<size_t, size_t>> merge_private_blocks(const std::vector<std::pair<size_t, size_t>>& src,
-                                                            const std::vector<std::pair<size_t, size_t>>& dst)
+std::vector<std::pair<size_t, size_t>> shift_and_frame_private_blocks(const std::vector<std::pair<size_t, size_t>>& vec,
+                                                                      size_t offset, size_t buff_size)
 {
   std::vector<std::pair<size_t, size_t>> result;
+  shift_and_frame_private_blocks(vec, offset, buff_size, result);
+  return result;
+}
+
+void merge_private_blocks(const std::vector<std::pair<size_t, size_t>>& src,
+                          const std::vector<std::pair<size_t, size_t>>& dst,
+                          std::vector<std::pair<size_t, size_t>>& result)
+{
+  result.clear();
   unsigned i_src = 0;
   unsigned i_dst = 0;
   while(i_src < src.size() && i_dst < dst.size()) {
@@ -414,6 +422,13 @@ std::vector<std::pair<size_t, size_t>> merge_private_blocks(const std::vector<st
           i_dst ++;
     }
   }
+}
+
+std::vector<std::pair<size_t, size_t>> merge_private_blocks(const std::vector<std::pair<size_t, size_t>>& src,
+                                                            const std::vector<std::pair<size_t, size_t>>& dst)
+{
+  std::vector<std::pair<size_t, size_t>> result;
+  merge_private_blocks(src, dst, result);
   return result;
 }
 
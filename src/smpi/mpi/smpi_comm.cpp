@@ -489,6 +489,18 @@ void Comm::finish_rma_calls(){
   }
 }
 
+/** @brief Returns the index of the algorithm picked for the given collective and message size, or -1 if none */
+int Comm::coll_choice(const std::string& key)
+{
+  auto it = coll_choices_.find(key);
+  return it == coll_choices_.end() ? -1 : it->second;
+}
+
+void Comm::set_coll_choice(const std::string& key, int coll)
+{
+  coll_choices_[key] = coll;
+}
+
 MPI_Comm Comm::split_type(int type, int key, MPI_Info info)
 {
   if(type != MPI_COMM_TYPE_SHARED){
@@ -10,34 +10,67 @@
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(smpi_op, smpi, "Logging specific to SMPI (op)");
 
-#define MAX_OP(a, b)  (b) = (a) < (b) ? (b) : (a)
-#define MIN_OP(a, b)  (b) = (a) < (b) ? (a) : (b)
-#define SUM_OP(a, b)  (b) += (a)
-#define PROD_OP(a, b) (b) *= (a)
-#define LAND_OP(a, b) (b) = (a) && (b)
-#define LOR_OP(a, b)  (b) = (a) || (b)
-#define LXOR_OP(a, b) (b) = (not(a) && (b)) || ((a) && not(b))
-#define BAND_OP(a, b) (b) &= (a)
-#define BOR_OP(a, b)  (b) |= (a)
-#define BXOR_OP(a, b) (b) ^= (a)
-#define MAXLOC_OP(a, b)  (b) = (a.value) < (b.value) ? (b) : ((a.value) == (b.value) ? ((a.index) < (b.index) ? (a) : (b)) : (a))
-#define MINLOC_OP(a, b)  (b) = (a.value) < (b.value) ? (a) : ((a.value) == (b.value) ? ((a.index) < (b.index) ? (a) : (b)) : (b))
-
-#define APPLY_FUNC(a, b, length, type, func) \
-{                                          \
-  int i;                                   \
-  type* x = (type*)(a);                    \
-  type* y = (type*)(b);                    \
-  for(i = 0; i < *(length); i++) {         \
-    func(x[i], y[i]);                      \
-  }                                        \
+/* The operators, applied to each element of the buffers by apply_op() */
+struct max_op {
+  template <typename T> void operator()(const T& a, T& b) const { b = a < b ? b : a; }
+};
+struct min_op {
+  template <typename T> void operator()(const T& a, T& b) const { b = a < b ? a : b; }
+};
+struct sum_op {
+  template <typename T> void operator()(const T& a, T& b) const { b += a; }
+};
+struct prod_op {
+  template <typename T> void operator()(const T& a, T& b) const { b *= a; }
+};
+struct land_op {
+  template <typename T> void operator()(const T& a, T& b) const { b = a && b; }
+};
+struct lor_op {
+  template <typename T> void operator()(const T& a, T& b) const { b = a || b; }
+};
+struct lxor_op {
+  template <typename T> void operator()(const T& a, T& b) const { b = (not a && b) || (a && not b); }
+};
+struct band_op {
+  template <typename T> void operator()(const T& a, T& b) const { b &= a; }
+};
+struct bor_op {
+  template <typename T> void operator()(const T& a, T& b) const { b |= a; }
+};
+struct bxor_op {
+  template <typename T> void operator()(const T& a, T& b) const { b ^= a; }
+};
+struct maxloc_op {
+  template <typename T> void operator()(const T& a, T& b) const
+  {
+    b = a.value < b.value ? b : (a.value == b.value ? (a.index < b.index ? a : b) : a);
+  }
+};
+struct minloc_op {
+  template <typename T> void operator()(const T& a, T& b) const
+  {
+    b = a.value < b.value ? a : (a.value == b.value ? (a.index < b.index ? a : b) : b);
+  }
+};
+
+/** @brief Applies the operator to all the elements
+ *
+ * The loop is specialized for each type and operator, and its bound is read once, so that the compiler can vectorize
+ * it (the stores to the buffer could otherwise modify the length, as far as the compiler knows).
+ */
+template <typename T, typename Op> static void apply_op(const void* a, void* b, int length, Op op)
+{
+  const T* x = static_cast<const T*>(a);
+  T* y       = static_cast<T*>(b);
+  for (int i = 0; i < length; i++)
+    op(x[i], y[i]);
 }
 
-#define APPLY_OP_LOOP(dtype, type, op) \
-  if (*datatype == dtype) {\
-    APPLY_FUNC(a, b, length, type, op)\
-  } else \
-
+#define APPLY_OP_LOOP(dtype, type, op)                                                                                 \
+  if (*datatype == dtype) {                                                                                            \
+    apply_op<type>(a, b, *length, op());                                                                               \
+  } else
 
 #define APPLY_BASIC_OP_LOOP(op)\
 APPLY_OP_LOOP(MPI_CHAR, char,op)\
@@ -103,86 +136,86 @@ APPLY_OP_LOOP(MPI_2LONG, long_long,op)
 
 static void max_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(MAX_OP)
-  APPLY_FLOAT_OP_LOOP(MAX_OP)
-  APPLY_END_OP_LOOP(MAX_OP)
+  APPLY_BASIC_OP_LOOP(max_op)
+  APPLY_FLOAT_OP_LOOP(max_op)
+  APPLY_END_OP_LOOP(max_op)
 }
 
 static void min_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(MIN_OP)
-  APPLY_FLOAT_OP_LOOP(MIN_OP)
-  APPLY_END_OP_LOOP(MIN_OP)
+  APPLY_BASIC_OP_LOOP(min_op)
+  APPLY_FLOAT_OP_LOOP(min_op)
+  APPLY_END_OP_LOOP(min_op)
 }
 
 static void sum_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(SUM_OP)
-  APPLY_FLOAT_OP_LOOP(SUM_OP)
-  APPLY_COMPLEX_OP_LOOP(SUM_OP)
-  APPLY_END_OP_LOOP(SUM_OP)
+  APPLY_BASIC_OP_LOOP(sum_op)
+  APPLY_FLOAT_OP_LOOP(sum_op)
+  APPLY_COMPLEX_OP_LOOP(sum_op)
+  APPLY_END_OP_LOOP(sum_op)
 }
 
 static void prod_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(PROD_OP)
-  APPLY_FLOAT_OP_LOOP(PROD_OP)
-  APPLY_COMPLEX_OP_LOOP(PROD_OP)
-  APPLY_END_OP_LOOP(PROD_OP)
+  APPLY_BASIC_OP_LOOP(prod_op)
+  APPLY_FLOAT_OP_LOOP(prod_op)
+  APPLY_COMPLEX_OP_LOOP(prod_op)
+  APPLY_END_OP_LOOP(prod_op)
 }
 
 static void land_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(LAND_OP)
-  APPLY_BOOL_OP_LOOP(LAND_OP)
-  APPLY_END_OP_LOOP(LAND_OP)
+  APPLY_BASIC_OP_LOOP(land_op)
+  APPLY_BOOL_OP_LOOP(land_op)
+  APPLY_END_OP_LOOP(land_op)
 }
 
 static void lor_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(LOR_OP)
-  APPLY_BOOL_OP_LOOP(LOR_OP)
-  APPLY_END_OP_LOOP(LOR_OP)
+  APPLY_BASIC_OP_LOOP(lor_op)
+  APPLY_BOOL_OP_LOOP(lor_op)
+  APPLY_END_OP_LOOP(lor_op)
 }
 
 static void lxor_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(LXOR_OP)
-  APPLY_BOOL_OP_LOOP(LXOR_OP)
-  APPLY_END_OP_LOOP(LXOR_OP)
+  APPLY_BASIC_OP_LOOP(lxor_op)
+  APPLY_BOOL_OP_LOOP(lxor_op)
+  APPLY_END_OP_LOOP(lxor_op)
 }
 
 static void band_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(BAND_OP)
-  APPLY_BOOL_OP_LOOP(BAND_OP)
-  APPLY_END_OP_LOOP(BAND_OP)
+  APPLY_BASIC_OP_LOOP(band_op)
+  APPLY_BOOL_OP_LOOP(band_op)
+  APPLY_END_OP_LOOP(band_op)
 }
 
 static void bor_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(BOR_OP)
-  APPLY_BOOL_OP_LOOP(BOR_OP)
-  APPLY_END_OP_LOOP(BOR_OP)
+  APPLY_BASIC_OP_LOOP(bor_op)
+  APPLY_BOOL_OP_LOOP(bor_op)
+  APPLY_END_OP_LOOP(bor_op)
 }
 
 static void bxor_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_BASIC_OP_LOOP(BXOR_OP)
-  APPLY_BOOL_OP_LOOP(BXOR_OP)
-  APPLY_END_OP_LOOP(BXOR_OP)
+  APPLY_BASIC_OP_LOOP(bxor_op)
+  APPLY_BOOL_OP_LOOP(bxor_op)
+  APPLY_END_OP_LOOP(bxor_op)
 }
 
 static void minloc_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_PAIR_OP_LOOP(MINLOC_OP)
-  APPLY_END_OP_LOOP(MINLOC_OP)
+  APPLY_PAIR_OP_LOOP(minloc_op)
+  APPLY_END_OP_LOOP(minloc_op)
 }
 
 static void maxloc_func(void *a, void *b, int *length, MPI_Datatype * datatype)
 {
-  APPLY_PAIR_OP_LOOP(MAXLOC_OP)
-  APPLY_END_OP_LOOP(MAXLOC_OP)
+  APPLY_PAIR_OP_LOOP(maxloc_op)
+  APPLY_END_OP_LOOP(maxloc_op)
 }
 
 static void replace_func(void *a, void *b, int *length, MPI_Datatype * datatype)
@@ -13,6 +13,7 @@
 #include "smpi_op.hpp"
 #include "smpi_process.hpp"
 #include "src/kernel/activity/CommImpl.hpp"
+#include "src/kernel/activity/MailboxImpl.hpp"
 #include "src/mc/mc_replay.hpp"
 #include "src/simix/ActorImpl.hpp"
 #include "xbt/config.hpp"
@@ -185,6 +186,19 @@ int Request::match_send(void* a, void* b, simgrid::kernel::activity::CommImpl* i
     return 0;
 }
 
+/** @brief Describes the messages accepted by a request, so that the mailboxes can index it.
+ *
+ * match_send() and match_recv() accept a message if its source and tag are the same as the request's ones, unless
+ * the request has a wildcard: in that case the descriptor is incomplete.
+ */
+bool Request::match_descriptor(void* a, simgrid::kernel::activity::MatchDescriptor* descriptor)
+{
+  MPI_Request req    = static_cast<MPI_Request>(a);
+  descriptor->source = req->src_;
+  descriptor->tag    = req->tag_;
+  return req->src_ != MPI_ANY_SOURCE && req->tag_ != MPI_ANY_TAG;
+}
+
 void Request::print_request(const char *message)
 {
   XBT_VERB("%s  request %p  [buf = %p, size = %zu, src = %d, dst = %d, tag = %d, flags = %x]",
@@ -429,6 +443,7 @@ void Request::start()
     this->print_request("New send");
 
     void* buf = buf_;
+    void (*free_buf)(void*) = &xbt_free_f;
     if ((flags_ & MPI_REQ_SSEND) == 0 &&
         ((flags_ & MPI_REQ_RMA) != 0 ||
          static_cast<int>(size_) < simgrid::config::get_value<int>("smpi/send-is-detached-thresh"))) {
@@ -445,8 +460,7 @@ void Request::start()
             XBT_DEBUG("Privatization : We are sending from a zone inside global memory. Switch data segment ");
             smpi_switch_data_segment(simgrid::s4u::Actor::by_pid(src_));
           }
-          buf = xbt_malloc(size_);
-          memcpy(buf,oldbuf,size_);
+          buf = smpi_detached_buffer_new(oldbuf, size_, &free_buf);
           XBT_DEBUG("buf %p copied into %p",oldbuf,buf);
         }
       }
@@ -504,7 +518,7 @@ void Request::start()
     real_size_=size_;
     action_   = simcall_comm_isend(
         simgrid::s4u::Actor::by_pid(src_)->get_impl(), mailbox, size_, -1.0, buf, real_size_, &match_send,
-        &xbt_free_f, // how to free the userdata if a detached send fails
+        free_buf, // how to free the userdata if a detached send fails
         not process->replaying() ? smpi_comm_copy_data_callback : &smpi_comm_null_copy_buffer_callback, this,
         // detach if msg size < eager/rdv switch limit
         detached_);
@@ -22,7 +22,7 @@ namespace surf {
 
 StorageModel::StorageModel() : Model(Model::UpdateAlgo::FULL)
 {
-  set_maxmin_system(new simgrid::kernel::lmm::System(true /* selective update */));
+  set_maxmin_system(simgrid::kernel::lmm::make_new_maxmin_system(true /* selective update */));
 }
 
 StorageModel::~StorageModel()
@@ -68,7 +68,7 @@ CpuCas01Model::CpuCas01Model(kernel::resource::Model::UpdateAlgo algo) : simgrid
     select = true;
   }
 
-  set_maxmin_system(new simgrid::kernel::lmm::System(select));
+  set_maxmin_system(simgrid::kernel::lmm::make_new_maxmin_system(select));
 }
 
 CpuCas01Model::~CpuCas01Model()
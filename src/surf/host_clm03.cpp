@@ -5,10 +5,14 @@
 
 #include "host_clm03.hpp"
 #include "simgrid/sg_config.hpp"
+#include "src/include/xbt/parmap.hpp"
 #include "surf/surf.hpp"
 
 XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(surf_host);
 
+static simgrid::config::Flag<bool> cfg_parallel_models{
+    "surf/parallel-models", "Compute the next event of the CPU, network and storage models in parallel threads", false};
+
 /*************
  * CallBacks *
  *************/
@@ -39,14 +43,62 @@ void surf_host_model_init_compound()
 namespace simgrid {
 namespace surf {
 
+HostCLM03Model::~HostCLM03Model()
+{
+  delete parmap_;
+}
+
+void HostCLM03Model::compute_next_event(NextEvent* job)
+{
+  job->date = job->model->next_occuring_event(job->now);
+}
+
+/** @brief Share the resources of the CPU, network and storage models in parallel threads.
+ *
+ * These models rely on distinct maxmin systems and action sets, so they can be solved concurrently. The results are
+ * stored in separate slots and merged afterward, which keeps the outcome independent of the threads' scheduling.
+ * The network model may finish some communications in the meantime: the signals of these state changes are only
+ * emitted afterward, from maestro, as their callbacks (tracing, plugins, user code) are not meant to run in threads.
+ */
+void HostCLM03Model::next_occuring_events_parallel(double now, double* min_by_cpu, double* min_by_net,
+                                                   double* min_by_sto)
+{
+  jobs_[0] = {surf_cpu_model_pm, now, -1};
+  jobs_[1] = {surf_storage_model, now, -1};
+  jobs_[2] = {surf_network_model, now, -1};
+  job_list_.clear();
+  job_list_.push_back(&jobs_[0]);
+  job_list_.push_back(&jobs_[1]);
+  if (surf_network_model->next_occuring_event_is_idempotent()) { // The NS3 model is run separately by surf_solve()
+    surf_network_model->defer_state_changes();
+    job_list_.push_back(&jobs_[2]);
+  }
+
+  if (parmap_ == nullptr)
+    parmap_ = new xbt::Parmap<NextEvent*>(3, XBT_PARMAP_DEFAULT);
+  parmap_->apply(&compute_next_event, job_list_);
+  surf_network_model->signal_deferred_state_changes();
+
+  *min_by_cpu = jobs_[0].date;
+  *min_by_sto = jobs_[1].date;
+  *min_by_net = jobs_[2].date;
+}
+
 double HostCLM03Model::next_occuring_event(double now)
 {
   ignore_empty_vm_in_pm_LMM();
 
-  double min_by_cpu = surf_cpu_model_pm->next_occuring_event(now);
-  double min_by_net =
-      surf_network_model->next_occuring_event_is_idempotent() ? surf_network_model->next_occuring_event(now) : -1;
-  double min_by_sto = surf_storage_model->next_occuring_event(now);
+  double min_by_cpu;
+  double min_by_net;
+  double min_by_sto;
+  if (cfg_parallel_models) {
+    next_occuring_events_parallel(now, &min_by_cpu, &min_by_net, &min_by_sto);
+  } else {
+    min_by_cpu = surf_cpu_model_pm->next_occuring_event(now);
+    min_by_net =
+        surf_network_model->next_occuring_event_is_idempotent() ? surf_network_model->next_occuring_event(now) : -1;
+    min_by_sto = surf_storage_model->next_occuring_event(now);
+  }
 
   XBT_DEBUG("model %p, %s min_by_cpu %f, %s min_by_net %f, %s min_by_sto %f",
       this, typeid(surf_cpu_model_pm).name(), min_by_cpu,
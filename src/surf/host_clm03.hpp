@@ -19,6 +19,9 @@
  ***********/
 
 namespace simgrid {
+namespace xbt {
+template <typename T> class Parmap;
+}
 namespace surf {
 
 class XBT_PRIVATE HostCLM03Model;
@@ -29,8 +32,23 @@ class XBT_PRIVATE HostCLM03Model;
 
 class HostCLM03Model : public HostModel {
 public:
+  ~HostCLM03Model() override;
   double next_occuring_event(double now) override;
   void update_actions_state(double now, double delta) override;
+
+private:
+  /** The next event of one of the underlying models, computed by a worker thread */
+  struct NextEvent {
+    kernel::resource::Model* model;
+    double now;
+    double date;
+  };
+  static void compute_next_event(NextEvent* job);
+  void next_occuring_events_parallel(double now, double* min_by_cpu, double* min_by_net, double* min_by_sto);
+
+  NextEvent jobs_[3];
+  std::vector<NextEvent*> job_list_;
+  xbt::Parmap<NextEvent*>* parmap_ = nullptr;
 };
 }
 }
@@ -7,6 +7,7 @@
 #include <numeric>
 
 #include "network_cm02.hpp"
+#include "simgrid/kernel/routing/NetZoneImpl.hpp"
 #include "simgrid/s4u/Host.hpp"
 #include "simgrid/sg_config.hpp"
 #include "src/surf/surf_interface.hpp"
@@ -398,6 +399,7 @@ void NetworkCm02Link::set_latency(double value)
   int numelem                  = 0;
 
   latency_.peak = value;
+  kernel::routing::NetZoneImpl::invalidate_route_cache(); // the cached routes have a stale latency
 
   while ((var = get_constraint()->get_variable_safe(&elem, &nextelem, &numelem))) {
     NetworkCm02Action* action = static_cast<NetworkCm02Action*>(var->get_id());
@@ -68,6 +68,15 @@ double NetworkModel::next_occuring_event_full(double now)
   return minRes;
 }
 
+/** @brief Stops deferring the state change signals, and emits the ones that were delayed, in order */
+void NetworkModel::signal_deferred_state_changes()
+{
+  state_changes_deferred_ = false;
+  for (NetworkAction* action : deferred_state_changes_)
+    s4u::Link::on_communication_state_change(action);
+  deferred_state_changes_.clear();
+}
+
 /************
  * Resource *
  ************/
@@ -165,7 +174,12 @@ void NetworkAction::set_state(Action::State state)
 {
   Action::State previous = get_state();
   Action::set_state(state);
-  if (previous != state) // Trigger only if the state changed
+  if (previous == state) // Trigger only if the state changed
+    return;
+  NetworkModel* model = static_cast<NetworkModel*>(get_model());
+  if (model->state_changes_deferred_)
+    model->deferred_state_changes_.push_back(this);
+  else
     s4u::Link::on_communication_state_change(this);
 }
 
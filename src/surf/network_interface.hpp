@@ -15,6 +15,7 @@
 
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 /***********
  * Classes *
@@ -100,7 +101,20 @@ public:
   virtual double bandwidthConstraint(double rate, double bound, double size);
   double next_occuring_event_full(double now) override;
 
+  /** @brief Delays the on_communication_state_change signals, until signal_deferred_state_changes() is called
+   *
+   * This is used when the next event of the model is computed on a worker thread, as the signal reaches user
+   * callbacks and the tracing that can only run in maestro.
+   */
+  void defer_state_changes() { state_changes_deferred_ = true; }
+  void signal_deferred_state_changes();
+
   LinkImpl* loopback_ = nullptr;
+
+private:
+  friend class NetworkAction;
+  bool state_changes_deferred_ = false;
+  std::vector<NetworkAction*> deferred_state_changes_;
 };
 
 /************
@@ -4,6 +4,7 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include "ptask_L07.hpp"
+#include "simgrid/kernel/routing/NetZoneImpl.hpp"
 #include "surf/surf.hpp"
 #include "src/instr/instr_private.hpp" // TRACE_is_enabled(). FIXME: remove by subscribing tracing to the surf signals
 #include "xbt/config.hpp"
@@ -144,11 +145,13 @@ void HostL07Model::update_actions_state(double now, double delta)
 
         if (link)
         {
-            TRACE_surf_link_set_utilization(link->get_cname(), action.get_category(), value, now, delta);
+            TRACE_surf_resource_set_utilization("LINK", "bandwidth_used", link->get_cname(), action.get_category(),
+                                                value, now, delta);
         }
         else if (cpu)
         {
-            TRACE_surf_host_set_utilization(cpu->get_cname(), action.get_category(), value,  now, delta);
+            TRACE_surf_resource_set_utilization("HOST", "power_used", cpu->get_cname(), action.get_category(), value,
+                                                now, delta);
         }
       }
     }
@@ -386,6 +389,7 @@ void LinkL07::set_latency(double value)
   const kernel::lmm::Element* elem = nullptr;
 
   latency_.peak = value;
+  kernel::routing::NetZoneImpl::invalidate_route_cache(); // the cached routes have a stale latency
   while ((var = get_constraint()->get_variable(&elem))) {
     action = static_cast<L07Action*>(var->get_id());
     action->updateBound();
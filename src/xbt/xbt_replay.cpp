@@ -4,11 +4,23 @@
 /* This program is free software; you can redistribute it and/or modify it
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
+#include "src/internal_config.h"
 #include "xbt/ex.hpp"
 #include "xbt/log.h"
 #include "xbt/replay.hpp"
+#include "xbt/xbt_os_thread.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#if HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(replay,xbt,"Replay trace reader");
 
@@ -19,6 +31,93 @@ std::ifstream* action_fs = nullptr;
 std::unordered_map<std::string, action_fun> action_funs;
 static std::unordered_map<std::string, std::queue<ReplayAction*>*> action_queues;
 
+/* Binary replay traces
+ *
+ * A binary trace starts with the 8 characters of binary_magic and a 32 bits version number. It is followed by records,
+ * which all start with a 32 bits word (all words are in the native byte order of the machine). If the high bit of that
+ * word is set, the record defines the next token of the dictionary: the other bits give its length, and its characters
+ * follow, padded to a multiple of 4 bytes. Otherwise, the record is an action made of that many tokens, each of them
+ * given by its 32 bits index in the dictionary.
+ *
+ * Such a trace is much smaller than the textual one, since every token is written only once, and its actions are
+ * decoded without any parsing nor memory allocation once the tokens are known.
+ */
+static const char binary_magic[8]  = {'S', 'G', 'R', 'E', 'P', 'L', 'A', 'Y'};
+constexpr uint32_t binary_version  = 1;
+constexpr uint32_t token_definition = 0x80000000U;
+
+static bool is_binary_header(const char* header)
+{
+  uint32_t version;
+  std::memcpy(&version, header + sizeof binary_magic, sizeof version);
+  return std::memcmp(header, binary_magic, sizeof binary_magic) == 0 && version == binary_version;
+}
+
+/** Binary trace in memory, typically a mapped file */
+class MemorySource {
+  const char* pos_;
+  const char* end_;
+
+public:
+  MemorySource(const char* begin, const char* end) : pos_(begin), end_(end) {}
+  bool read(void* dest, std::size_t size)
+  {
+    if (static_cast<std::size_t>(end_ - pos_) < size)
+      return false;
+    std::memcpy(dest, pos_, size);
+    pos_ += size;
+    return true;
+  }
+};
+
+/** Binary trace read from a stream */
+class StreamSource {
+  std::istream* is_;
+
+public:
+  explicit StreamSource(std::istream* is) : is_(is) {}
+  bool read(void* dest, std::size_t size)
+  {
+    is_->read(static_cast<char*>(dest), size);
+    return static_cast<std::size_t>(is_->gcount()) == size;
+  }
+};
+
+template <class Source> class BinaryDecoder {
+  Source source_;
+  std::vector<std::string> tokens_;
+  std::vector<uint32_t> ids_;
+
+public:
+  explicit BinaryDecoder(Source source) : source_(source) {}
+  /** Decode the next action, reusing the strings already in *action. Returns false at the end of the trace. */
+  bool get(ReplayAction* action)
+  {
+    uint32_t word;
+    while (source_.read(&word, sizeof word)) {
+      if (word & token_definition) {
+        uint32_t length = word & ~token_definition;
+        char padding[3];
+        tokens_.emplace_back(length, '\0');
+        xbt_assert(source_.read(&tokens_.back()[0], length) && source_.read(padding, (4 - length % 4) % 4),
+                   "Truncated binary replay trace");
+        continue;
+      }
+      xbt_assert(word > 0, "Empty action in binary replay trace");
+      ids_.resize(word);
+      xbt_assert(source_.read(ids_.data(), word * sizeof(uint32_t)), "Truncated binary replay trace");
+      action->resize(word);
+      for (uint32_t i = 0; i < word; i++) {
+        xbt_assert(ids_[i] < tokens_.size(), "Invalid token %u in binary replay trace", ids_[i]);
+        (*action)[i].assign(tokens_[ids_[i]]);
+      }
+      XBT_DEBUG("got from binary trace an action of %u tokens", word);
+      return true;
+    }
+    return false;
+  }
+};
+
 static void read_and_trim_line(std::ifstream* fs, std::string* line)
 {
   do {
@@ -28,32 +127,271 @@ static void read_and_trim_line(std::ifstream* fs, std::string* line)
   XBT_DEBUG("got from trace: %s", line->c_str());
 }
 
-class ReplayReader {
-  std::ifstream* fs;
+/** A textual per-actor trace, whose actions are read and split ahead of time by the ReplayPrefetcher */
+struct PrefetchedTrace {
+  static constexpr unsigned capacity = 128;
+
+  explicit PrefetchedTrace(std::ifstream* fs) : fs(fs), actions(capacity) {}
+  std::unique_ptr<std::ifstream> fs;
+  std::vector<ReplayAction> actions; /* ring buffer of the actions that are ready */
+  unsigned first = 0;                /* index of the next action to replay in actions */
+  unsigned count = 0;                /* amount of actions ready */
+  bool eof       = false;            /* whether the end of the file was reached by the prefetcher */
+  bool busy      = false;            /* whether the prefetcher is filling the buffer */
+};
+constexpr unsigned PrefetchedTrace::capacity;
+
+/** @brief Reads the textual per-actor traces in a background thread.
+ *
+ * When each actor has its own trace file, reading them line by line when the actors need their next action results in
+ * many small synchronous reads scattered over many files. Instead, this thread reads and splits chunks of actions of
+ * each trace whose ring buffer is half empty, so that the actors usually find their next action ready.
+ */
+class ReplayPrefetcher {
+  xbt_os_mutex_t mutex_ = xbt_os_mutex_init();
+  xbt_os_cond_t work_   = xbt_os_cond_init(); /* signaled when a buffer needs to be filled, or on termination */
+  xbt_os_cond_t ready_  = xbt_os_cond_init(); /* signaled when a buffer was filled */
+  std::vector<PrefetchedTrace*> traces_;
+  unsigned next_             = 0; /* where to start looking for work in traces_, for fairness */
+  xbt_os_thread_t thread_    = nullptr;
+  bool done_                 = false;
+
+  static bool needs_work(const PrefetchedTrace* trace)
+  {
+    return not trace->eof && not trace->busy && trace->count <= PrefetchedTrace::capacity / 2;
+  }
+  static void* prefetcher_main(void* arg);
+  static void fill(PrefetchedTrace* trace, unsigned from, unsigned amount, unsigned* filled, bool* eof);
+
+public:
+  ReplayPrefetcher() = default;
+  ReplayPrefetcher(const ReplayPrefetcher&) = delete;
+  ReplayPrefetcher& operator=(const ReplayPrefetcher&) = delete;
+  ~ReplayPrefetcher();
+
+  void add(PrefetchedTrace* trace);
+  void remove(PrefetchedTrace* trace);
+  bool get(PrefetchedTrace* trace, ReplayAction* action);
+};
+
+static ReplayPrefetcher& get_prefetcher()
+{
+  static ReplayPrefetcher prefetcher;
+  return prefetcher;
+}
+
+ReplayPrefetcher::~ReplayPrefetcher()
+{
+  if (thread_ != nullptr) {
+    xbt_os_mutex_acquire(mutex_);
+    done_ = true;
+    xbt_os_cond_signal(work_);
+    xbt_os_mutex_release(mutex_);
+    xbt_os_thread_join(thread_, nullptr);
+  }
+  xbt_os_cond_destroy(ready_);
+  xbt_os_cond_destroy(work_);
+  xbt_os_mutex_destroy(mutex_);
+}
+
+void ReplayPrefetcher::add(PrefetchedTrace* trace)
+{
+  xbt_os_mutex_acquire(mutex_);
+  traces_.push_back(trace);
+  if (thread_ == nullptr)
+    thread_ = xbt_os_thread_create("replay prefetcher", prefetcher_main, this, nullptr);
+  xbt_os_cond_signal(work_);
+  xbt_os_mutex_release(mutex_);
+}
+
+void ReplayPrefetcher::remove(PrefetchedTrace* trace)
+{
+  xbt_os_mutex_acquire(mutex_);
+  while (trace->busy)
+    xbt_os_cond_wait(ready_, mutex_);
+  traces_.erase(std::find(traces_.begin(), traces_.end(), trace));
+  xbt_os_mutex_release(mutex_);
+}
+
+/** Take the next action of that trace, waiting for the prefetcher if it is not ready yet */
+bool ReplayPrefetcher::get(PrefetchedTrace* trace, ReplayAction* action)
+{
+  xbt_os_mutex_acquire(mutex_);
+  while (trace->count == 0 && not trace->eof) {
+    xbt_os_cond_signal(work_);
+    xbt_os_cond_wait(ready_, mutex_);
+  }
+  bool found = trace->count > 0;
+  if (found) {
+    std::swap(*action, trace->actions[trace->first]);
+    trace->first = (trace->first + 1) % PrefetchedTrace::capacity;
+    trace->count--;
+    if (needs_work(trace))
+      xbt_os_cond_signal(work_);
+  }
+  xbt_os_mutex_release(mutex_);
+  return found;
+}
+
+/* Read and split up to amount actions into the free slots of the buffer, starting at index from */
+void ReplayPrefetcher::fill(PrefetchedTrace* trace, unsigned from, unsigned amount, unsigned* filled, bool* eof)
+{
   std::string line;
+  for (*filled = 0; *filled < amount; (*filled)++) {
+    read_and_trim_line(trace->fs.get(), &line);
+    if (trace->fs->eof()) {
+      *eof = true;
+      return;
+    }
+    ReplayAction& action = trace->actions[(from + *filled) % PrefetchedTrace::capacity];
+    boost::split(action, line, boost::is_any_of(" \t"), boost::token_compress_on);
+  }
+}
+
+void* ReplayPrefetcher::prefetcher_main(void* arg)
+{
+  ReplayPrefetcher* prefetcher = static_cast<ReplayPrefetcher*>(arg);
+
+  xbt_os_mutex_acquire(prefetcher->mutex_);
+  while (not prefetcher->done_) {
+    /* Look for a trace to fill, in a round-robin fashion */
+    std::vector<PrefetchedTrace*>& traces = prefetcher->traces_;
+    PrefetchedTrace* trace                = nullptr;
+    for (unsigned i = 0; i < traces.size() && trace == nullptr; i++) {
+      unsigned pos = (prefetcher->next_ + i) % traces.size();
+      if (needs_work(traces[pos])) {
+        trace             = traces[pos];
+        prefetcher->next_ = pos + 1;
+      }
+    }
+    if (trace == nullptr) {
+      xbt_os_cond_wait(prefetcher->work_, prefetcher->mutex_);
+      continue;
+    }
+
+    /* The free slots of the ring buffer are not accessed by the actor, so they are filled without holding the lock */
+    unsigned from   = (trace->first + trace->count) % PrefetchedTrace::capacity;
+    unsigned amount = PrefetchedTrace::capacity - trace->count;
+    unsigned filled;
+    bool eof    = false;
+    trace->busy = true;
+    xbt_os_mutex_release(prefetcher->mutex_);
+    fill(trace, from, amount, &filled, &eof);
+    xbt_os_mutex_acquire(prefetcher->mutex_);
+    trace->busy = false;
+    trace->count += filled;
+    trace->eof = eof;
+    xbt_os_cond_broadcast(prefetcher->ready_);
+  }
+  xbt_os_mutex_release(prefetcher->mutex_);
+  return nullptr;
+}
+
+class ReplayReader {
+  std::unique_ptr<PrefetchedTrace> trace;
+  /* For binary traces: the content of the file, and the decoder reading it */
+  const char* data = nullptr;
+  std::size_t size = 0;
+  std::unique_ptr<BinaryDecoder<MemorySource>> decoder;
+
+  void open_binary(const char* filename);
 
 public:
   explicit ReplayReader(const char* filename)
   {
     XBT_VERB("Prepare to replay file '%s'", filename);
-    fs = new std::ifstream(filename, std::ifstream::in);
+    std::ifstream* fs = new std::ifstream(filename, std::ifstream::in | std::ifstream::binary);
     xbt_assert(fs->is_open(), "Cannot read replay file '%s'", filename);
+    char header[sizeof binary_magic + sizeof binary_version];
+    if (fs->read(header, sizeof header) && is_binary_header(header)) {
+      delete fs;
+      open_binary(filename);
+    } else {
+      fs->clear();
+      fs->seekg(0);
+      trace.reset(new PrefetchedTrace(fs));
+      get_prefetcher().add(trace.get());
+    }
   }
   ReplayReader(const ReplayReader&) = delete;
   ReplayReader& operator=(const ReplayReader&) = delete;
   ~ReplayReader()
   {
-    delete fs;
+    if (trace)
+      get_prefetcher().remove(trace.get());
+#if HAVE_MMAP
+    if (data != nullptr)
+      munmap(const_cast<char*>(data), size);
+#else
+    delete[] data;
+#endif
   }
   bool get(ReplayAction* action);
 };
 
+/** Map a binary trace in memory (or load it on systems without mmap) */
+void ReplayReader::open_binary(const char* filename)
+{
+  XBT_VERB("'%s' is a binary replay trace", filename);
+#if HAVE_MMAP
+  int fd = open(filename, O_RDONLY);
+  xbt_assert(fd >= 0, "Cannot read replay file '%s'", filename);
+  struct stat st;
+  xbt_assert(fstat(fd, &st) == 0, "Cannot stat replay file '%s'", filename);
+  size         = st.st_size;
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  xbt_assert(mapped != MAP_FAILED, "Cannot map replay file '%s': %s", filename, strerror(errno));
+  close(fd);
+  madvise(mapped, size, MADV_SEQUENTIAL);
+  data = static_cast<const char*>(mapped);
+#else
+  std::ifstream is(filename, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+  size         = is.tellg();
+  char* buffer = new char[size];
+  is.seekg(0);
+  is.read(buffer, size);
+  data = buffer;
+#endif
+  std::size_t header = sizeof binary_magic + sizeof binary_version;
+  decoder.reset(new BinaryDecoder<MemorySource>(MemorySource(data + header, data + size)));
+}
+
 bool ReplayReader::get(ReplayAction* action)
 {
-  read_and_trim_line(fs, &line);
+  if (decoder)
+    return decoder->get(action);
+  return get_prefetcher().get(trace.get(), action);
+}
 
-  boost::split(*action, line, boost::is_any_of(" \t"), boost::token_compress_on);
-  return not fs->eof();
+/* Decoder of the simulation-wide trace action_fs, if it is a binary one */
+static std::unique_ptr<BinaryDecoder<StreamSource>> action_fs_decoder;
+static std::ifstream* action_fs_inspected = nullptr;
+
+/** Read the next action of the simulation-wide trace, whatever its format */
+static bool read_shared_action(ReplayAction* action)
+{
+  if (action_fs_inspected != action_fs) {
+    action_fs_inspected = action_fs;
+    action_fs_decoder.reset();
+    char header[sizeof binary_magic + sizeof binary_version];
+    if (action_fs->read(header, sizeof header) && is_binary_header(header)) {
+      XBT_VERB("The shared replay trace is a binary one");
+      action_fs_decoder.reset(new BinaryDecoder<StreamSource>(StreamSource(action_fs)));
+    } else {
+      action_fs->clear();
+      action_fs->seekg(0);
+    }
+  }
+  if (action_fs_decoder)
+    return action_fs_decoder->get(action); // Never returns an empty action
+
+  std::string action_line;
+  read_and_trim_line(action_fs, &action_line);
+  if (action_fs->eof())
+    return false;
+  /* The trimmed line is not empty, so there is at least one token */
+  boost::split(*action, action_line, boost::is_any_of(" \t"), boost::token_compress_on);
+  return true;
 }
 
 static ReplayAction* get_action(char* name)
@@ -66,13 +404,12 @@ static ReplayAction* get_action(char* name)
   if (myqueue == nullptr || myqueue->empty()) { // Nothing stored for me. Read the file further
     // Read lines until I reach something for me (which breaks in loop body) or end of file reached
     while (true) {
-      std::string action_line;
-      read_and_trim_line(action_fs, &action_line);
-      if (action_fs->eof())
-        break;
       /* we cannot split in place here because we parse&store several lines for the colleagues... */
       action = new ReplayAction();
-      boost::split(*action, action_line, boost::is_any_of(" \t"), boost::token_compress_on);
+      if (not read_shared_action(action)) {
+        delete action;
+        break;
+      }
 
       // if it's for me, I'm done
       std::string evtname = action->front();
@@ -104,6 +441,7 @@ static ReplayAction* get_action(char* name)
 
 static void handle_action(ReplayAction& action)
 {
+  xbt_assert(action.size() >= 2, "Replay error: the action '%s' has no type", action.front().c_str());
   XBT_DEBUG("%s replays a %s action", action.at(0).c_str(), action.at(1).c_str());
   action_fun function = action_funs.at(action.at(1));
   try {
@@ -114,6 +452,52 @@ static void handle_action(ReplayAction& action)
   }
 }
 
+/**
+ * \ingroup XBT_replay
+ * \brief Convert a textual replay trace into the binary format
+ *
+ * Both kinds of traces can be given to the replay, which detects the binary ones by their header.
+ */
+void replay_convert_to_binary(const char* text_file, const char* binary_file)
+{
+  std::ifstream in(text_file, std::ifstream::in);
+  xbt_assert(in.is_open(), "Cannot read replay file '%s'", text_file);
+  std::ofstream out(binary_file, std::ofstream::out | std::ofstream::binary);
+  xbt_assert(out.is_open(), "Cannot write binary replay file '%s'", binary_file);
+
+  out.write(binary_magic, sizeof binary_magic);
+  out.write(reinterpret_cast<const char*>(&binary_version), sizeof binary_version);
+
+  std::unordered_map<std::string, uint32_t> token_ids;
+  std::vector<uint32_t> record;
+  std::string line;
+  ReplayAction action;
+  while (true) {
+    read_and_trim_line(&in, &line);
+    if (in.eof())
+      break;
+    boost::split(action, line, boost::is_any_of(" \t"), boost::token_compress_on);
+
+    record.clear();
+    record.push_back(action.size());
+    for (std::string const& token : action) {
+      auto it = token_ids.find(token);
+      if (it == token_ids.end()) {
+        static const char padding[3] = {0, 0, 0};
+        uint32_t definition          = token_definition | token.size();
+        out.write(reinterpret_cast<const char*>(&definition), sizeof definition);
+        out.write(token.data(), token.size());
+        out.write(padding, (4 - token.size() % 4) % 4);
+        it = token_ids.insert({token, token_ids.size()}).first;
+      }
+      record.push_back(it->second);
+    }
+    out.write(reinterpret_cast<const char*>(record.data()), record.size() * sizeof(uint32_t));
+  }
+  xbt_assert(out.good(), "Error while writing binary replay file '%s'", binary_file);
+  XBT_VERB("Converted '%s' into '%s' (%zu distinct tokens)", text_file, binary_file, token_ids.size());
+}
+
 /**
  * \ingroup XBT_replay
  * \brief function used internally to actually run the replay
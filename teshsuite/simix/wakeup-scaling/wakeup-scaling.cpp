@@ -0,0 +1,88 @@
+/* wakeup-scaling -- wakes up and kills many actors at once                 */
+
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* The scheduling of the woken up actors should take a time that is linear in the amount of actors.
+ * Pass the amount of actors as second parameter, and use --log=test.thres:verbose to see the timings (with
+ * --cfg=contexts/guard-size:0 for more than about 30,000 actors, as each guard page needs its own mapping). */
+
+#include "simgrid/s4u.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(test, "Messages specific for this test");
+
+static int actor_count = 1000;
+static int woken       = 0;
+static std::vector<int> wake_order;
+
+static void waiter(simgrid::s4u::MutexPtr mutex, simgrid::s4u::ConditionVariablePtr cond, int rank)
+{
+  std::unique_lock<simgrid::s4u::Mutex> lock(*mutex);
+  cond->wait(lock);
+  woken++;
+  wake_order.push_back(rank);
+}
+
+static void sleeper()
+{
+  simgrid::s4u::this_actor::sleep_for(1000);
+  xbt_die("This actor should have been killed");
+}
+
+static void master()
+{
+  simgrid::s4u::Host* host                 = simgrid::s4u::this_actor::get_host();
+  simgrid::s4u::MutexPtr mutex             = simgrid::s4u::Mutex::create();
+  simgrid::s4u::ConditionVariablePtr cond  = simgrid::s4u::ConditionVariable::create();
+  xbt_os_timer_t timer                     = xbt_os_timer_new();
+
+  XBT_INFO("Wake up %d actors at once", actor_count);
+  for (int i = 0; i < actor_count; i++)
+    simgrid::s4u::Actor::create("waiter", host, waiter, mutex, cond, i);
+  simgrid::s4u::this_actor::sleep_for(1);
+  xbt_os_cputimer_start(timer);
+  mutex->lock();
+  cond->notify_all();
+  mutex->unlock();
+  simgrid::s4u::this_actor::sleep_for(1);
+  xbt_os_cputimer_stop(timer);
+  bool ordered = true;
+  for (int i = 0; i < woken; i++)
+    ordered = ordered && wake_order[i] == i;
+  XBT_INFO("%d actors woken up, %s", woken, ordered ? "in order" : "NOT IN ORDER");
+  XBT_VERB("Woken up in %f seconds", xbt_os_timer_elapsed(timer));
+
+  XBT_INFO("Kill %d sleeping actors at once", actor_count);
+  for (int i = 0; i < actor_count; i++)
+    simgrid::s4u::Actor::create("sleeper", host, sleeper);
+  simgrid::s4u::this_actor::sleep_for(1);
+  xbt_os_cputimer_start(timer);
+  simgrid::s4u::Actor::kill_all();
+  simgrid::s4u::this_actor::yield();
+  xbt_os_cputimer_stop(timer);
+  XBT_INFO("%zu actors remaining", simgrid::s4u::Engine::get_instance()->get_actor_count());
+  XBT_VERB("Killed in %f seconds", xbt_os_timer_elapsed(timer));
+
+  xbt_os_timer_free(timer);
+}
+
+int main(int argc, char* argv[])
+{
+  simgrid::s4u::Engine e(&argc, argv);
+  xbt_assert(argc > 1, "Usage: %s platform_file [actor_count]\n", argv[0]);
+  if (argc > 2)
+    actor_count = std::atoi(argv[2]);
+
+  e.load_platform(argv[1]);
+  simgrid::s4u::Actor::create("master", simgrid::s4u::Host::by_name("Tremblay"), master);
+  e.run();
+
+  return 0;
+}
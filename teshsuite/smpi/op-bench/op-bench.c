@@ -0,0 +1,169 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* Microbenchmark of the builtin reduction operators. Each builtin operator is applied with MPI_Reduce_local, and
+ * compared to a user-defined operator written as the plain loops that implemented the builtin operators before they
+ * got specialized for each type (dispatching on the datatype, and reading the length through its pointer in the loop).
+ * The results must be identical. The timings are only displayed when a count is given on the command line:
+ *   smpirun -np 1 op-bench [count [repetitions]]
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct double_int {
+  double value;
+  int index;
+};
+
+#define REFERENCE_LOOP(type, expr)                                                                                     \
+  {                                                                                                                    \
+    type* x = (type*)a;                                                                                                \
+    type* y = (type*)b;                                                                                                \
+    for (int i = 0; i < *len; i++)                                                                                     \
+      expr;                                                                                                            \
+  }
+
+#define REFERENCE_ARITH(name, expr)                                                                                    \
+  static void reference_##name(void* a, void* b, int* len, MPI_Datatype* datatype)                                     \
+  {                                                                                                                    \
+    if (*datatype == MPI_INT)                                                                                          \
+      REFERENCE_LOOP(int, expr)                                                                                        \
+    else if (*datatype == MPI_FLOAT)                                                                                   \
+      REFERENCE_LOOP(float, expr)                                                                                      \
+    else if (*datatype == MPI_DOUBLE)                                                                                  \
+      REFERENCE_LOOP(double, expr)                                                                                     \
+  }
+
+#define REFERENCE_INT(name, expr)                                                                                      \
+  static void reference_##name(void* a, void* b, int* len, MPI_Datatype* datatype)                                     \
+  {                                                                                                                    \
+    if (*datatype == MPI_INT)                                                                                          \
+      REFERENCE_LOOP(int, expr)                                                                                        \
+  }
+
+#define REFERENCE_PAIR(name, expr)                                                                                     \
+  static void reference_##name(void* a, void* b, int* len, MPI_Datatype* datatype)                                     \
+  {                                                                                                                    \
+    if (*datatype == MPI_DOUBLE_INT)                                                                                   \
+      REFERENCE_LOOP(struct double_int, expr)                                                                          \
+  }
+
+REFERENCE_ARITH(max, y[i] = x[i] < y[i] ? y[i] : x[i])
+REFERENCE_ARITH(min, y[i] = x[i] < y[i] ? x[i] : y[i])
+REFERENCE_ARITH(sum, y[i] += x[i])
+REFERENCE_ARITH(prod, y[i] *= x[i])
+REFERENCE_INT(land, y[i] = x[i] && y[i])
+REFERENCE_INT(lor, y[i] = x[i] || y[i])
+REFERENCE_INT(lxor, y[i] = (!x[i] && y[i]) || (x[i] && !y[i]))
+REFERENCE_INT(band, y[i] &= x[i])
+REFERENCE_INT(bor, y[i] |= x[i])
+REFERENCE_INT(bxor, y[i] ^= x[i])
+REFERENCE_PAIR(maxloc, y[i] = x[i].value < y[i].value
+                                  ? y[i]
+                                  : (x[i].value == y[i].value ? (x[i].index < y[i].index ? x[i] : y[i]) : x[i]))
+REFERENCE_PAIR(minloc, y[i] = x[i].value < y[i].value
+                                  ? x[i]
+                                  : (x[i].value == y[i].value ? (x[i].index < y[i].index ? x[i] : y[i]) : y[i]))
+
+/* Values that keep the products and sums small, whatever the amount of repetitions */
+static void fill(void* buf, MPI_Datatype type, int count, int seed)
+{
+  for (int i = 0; i < count; i++) {
+    int v = (i * 7 + seed) % 3 - 1;
+    if (type == MPI_INT)
+      ((int*)buf)[i] = v;
+    else if (type == MPI_FLOAT)
+      ((float*)buf)[i] = 1.0f + v * 1e-3f;
+    else if (type == MPI_DOUBLE)
+      ((double*)buf)[i] = 1.0 + v * 1e-3;
+    else {
+      ((struct double_int*)buf)[i].value = v;
+      ((struct double_int*)buf)[i].index = (i + seed) % 5;
+    }
+  }
+}
+
+static int same_results(const void* a, const void* b, MPI_Datatype type, int count, int size)
+{
+  if (type != MPI_DOUBLE_INT)
+    return memcmp(a, b, (size_t)count * size) == 0;
+  /* Do not compare the padding of the structures */
+  for (int i = 0; i < count; i++)
+    if (((struct double_int*)a)[i].value != ((struct double_int*)b)[i].value ||
+        ((struct double_int*)a)[i].index != ((struct double_int*)b)[i].index)
+      return 0;
+  return 1;
+}
+
+static double bench(MPI_Op op, MPI_Datatype type, void* in, void* inout, int count, int reps)
+{
+  clock_t start = clock();
+  for (int r = 0; r < reps; r++)
+    MPI_Reduce_local(in, inout, count, type, op);
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void run(const char* name, MPI_Op op, MPI_User_function* reference, MPI_Datatype type, const char* type_name,
+                int count, int reps, int verbose)
+{
+  int size;
+  MPI_Type_size(type, &size);
+  void* in        = malloc((size_t)count * size);
+  void* inout     = malloc((size_t)count * size);
+  void* inout_ref = malloc((size_t)count * size);
+  fill(in, type, count, 0);
+  fill(inout, type, count, 1);
+  memcpy(inout_ref, inout, (size_t)count * size);
+
+  MPI_Op reference_op;
+  MPI_Op_create(reference, 1, &reference_op);
+  double time_ref = bench(reference_op, type, in, inout_ref, count, reps);
+  double time     = bench(op, type, in, inout, count, reps);
+  MPI_Op_free(&reference_op);
+
+  if (!same_results(inout, inout_ref, type, count, size)) {
+    printf("%-6s %-10s: results differ from the reference\n", name, type_name);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  if (verbose)
+    printf("%-6s %-10s: %8.3f ms instead of %8.3f ms (x%.2f)\n", name, type_name, time * 1e3, time_ref * 1e3,
+           time > 0 ? time_ref / time : 0.0);
+  else
+    printf("%-6s %-10s: ok\n", name, type_name);
+  free(in);
+  free(inout);
+  free(inout_ref);
+}
+
+int main(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+  int verbose = argc > 1;
+  int count   = verbose ? atoi(argv[1]) : 1000;
+  int reps    = argc > 2 ? atoi(argv[2]) : 10;
+
+  MPI_Datatype arith_types[] = {MPI_INT, MPI_FLOAT, MPI_DOUBLE};
+  const char* arith_names[]  = {"MPI_INT", "MPI_FLOAT", "MPI_DOUBLE"};
+  for (int t = 0; t < 3; t++) {
+    run("max", MPI_MAX, reference_max, arith_types[t], arith_names[t], count, reps, verbose);
+    run("min", MPI_MIN, reference_min, arith_types[t], arith_names[t], count, reps, verbose);
+    run("sum", MPI_SUM, reference_sum, arith_types[t], arith_names[t], count, reps, verbose);
+    run("prod", MPI_PROD, reference_prod, arith_types[t], arith_names[t], count, reps, verbose);
+  }
+  run("land", MPI_LAND, reference_land, MPI_INT, "MPI_INT", count, reps, verbose);
+  run("lor", MPI_LOR, reference_lor, MPI_INT, "MPI_INT", count, reps, verbose);
+  run("lxor", MPI_LXOR, reference_lxor, MPI_INT, "MPI_INT", count, reps, verbose);
+  run("band", MPI_BAND, reference_band, MPI_INT, "MPI_INT", count, reps, verbose);
+  run("bor", MPI_BOR, reference_bor, MPI_INT, "MPI_INT", count, reps, verbose);
+  run("bxor", MPI_BXOR, reference_bxor, MPI_INT, "MPI_INT", count, reps, verbose);
+  run("maxloc", MPI_MAXLOC, reference_maxloc, MPI_DOUBLE_INT, "DOUBLE_INT", count, reps, verbose);
+  run("minloc", MPI_MINLOC, reference_minloc, MPI_DOUBLE_INT, "DOUBLE_INT", count, reps, verbose);
+
+  MPI_Finalize();
+  return 0;
+}
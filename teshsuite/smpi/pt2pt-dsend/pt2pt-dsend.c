@@ -4,11 +4,18 @@
 /* This program is free software; you can redistribute it and/or modify it
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
-/* This program simply does a very small exchange to test whether using SIMIX dsend to model the eager mode works */
+/* This program simply does a very small exchange to test whether using SIMIX dsend to model the eager mode works.
+ * With the "large" argument, it also sends a large message in eager mode, from and to page-aligned buffers (but for
+ * the first few bytes, so that the message does not start nor end on a page boundary). */
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <mpi.h>
 
+#define LARGE_COUNT (256 * 1024)
+#define LARGE_OFFSET 3
+
 XBT_LOG_NEW_DEFAULT_CATEGORY(dsend,"the dsend test");
 
 int main(int argc, char *argv[]) {
@@ -40,6 +47,28 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (argc > 1 && strcmp(argv[1], "large") == 0) {
+    void* alloc;
+    if (posix_memalign(&alloc, 4096, (LARGE_COUNT + LARGE_OFFSET) * sizeof(int32_t)) != 0)
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    int32_t* large = (int32_t*)alloc + LARGE_OFFSET;
+    if (rank == 1) {
+      for (int i = 0; i < LARGE_COUNT; i++)
+        large[i] = i;
+      MPI_Send(large, LARGE_COUNT, MPI_INT32_T, (rank + 1) % 2, 666, MPI_COMM_WORLD);
+      memset(large, 0, LARGE_COUNT * sizeof(int32_t)); /* the message was copied, the buffer can be reused */
+    } else {
+      memset(large, 0, LARGE_COUNT * sizeof(int32_t));
+      MPI_Recv(large, LARGE_COUNT, MPI_INT32_T, MPI_ANY_SOURCE, 666, MPI_COMM_WORLD, NULL);
+      for (int i = 0; i < LARGE_COUNT; i++)
+        if (large[i] != i) {
+          printf("rank %d: Damn, large data does not match at %d (got %d)\n", rank, i, large[i]);
+          break;
+        }
+    }
+    free(alloc);
+  }
+
   XBT_INFO("rank %d: data exchanged", rank);
   MPI_Finalize();
   return 0;
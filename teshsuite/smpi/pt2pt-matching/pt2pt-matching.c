@@ -0,0 +1,92 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* This program checks the matching order of the messages when the receiver has many unexpected messages, mixing
+ * receives from a given source and tag (that the mailboxes index) with wildcard receives. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+
+#define NB_TAGS 50
+#define NB_ROUNDS 20
+
+static int payload(int rank, int round, int tag)
+{
+  return (rank * NB_ROUNDS + round) * NB_TAGS + tag;
+}
+
+static void check(int rank, int got, int expected, const char* what)
+{
+  if (got != expected) {
+    printf("rank %d: %s: got %d instead of %d\n", rank, what, got, expected);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  int rank;
+  int size;
+  MPI_Status status;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  if (rank != 0) {
+    /* Each tag is sent NB_ROUNDS times, so that the receiver has to respect the order of the messages of each tag */
+    int* data            = (int*)malloc(NB_ROUNDS * NB_TAGS * sizeof(int));
+    MPI_Request* request = (MPI_Request*)malloc(NB_ROUNDS * NB_TAGS * sizeof(MPI_Request));
+    for (int round = 0; round < NB_ROUNDS; round++)
+      for (int tag = 0; tag < NB_TAGS; tag++) {
+        int i   = round * NB_TAGS + tag;
+        data[i] = payload(rank, round, tag);
+        MPI_Isend(&data[i], 1, MPI_INT, 0, tag, MPI_COMM_WORLD, &request[i]);
+      }
+    MPI_Waitall(NB_ROUNDS * NB_TAGS, request, MPI_STATUSES_IGNORE);
+    free(request);
+    free(data);
+  } else {
+    int value;
+    int count = 0;
+    /* The first half of the rounds: the tags in reverse order, from each source in turn */
+    for (int round = 0; round < NB_ROUNDS / 2; round++)
+      for (int tag = NB_TAGS - 1; tag >= 0; tag--)
+        for (int src = 1; src < size; src++) {
+          MPI_Recv(&value, 1, MPI_INT, src, tag, MPI_COMM_WORLD, &status);
+          check(rank, value, payload(src, round, tag), "specific receive");
+          count++;
+        }
+    /* Then a given tag from any source: the messages of each source come in order */
+    int next_round[size];
+    for (int src = 1; src < size; src++)
+      next_round[src] = NB_ROUNDS / 2;
+    for (int i = 0; i < size - 1; i++) {
+      MPI_Recv(&value, 1, MPI_INT, MPI_ANY_SOURCE, NB_TAGS / 2, MPI_COMM_WORLD, &status);
+      check(rank, value, payload(status.MPI_SOURCE, next_round[status.MPI_SOURCE], NB_TAGS / 2), "any source");
+      next_round[status.MPI_SOURCE]++;
+      count++;
+    }
+    /* Then any tag from a given source, in sending order, interleaved with specific receives of the last tag */
+    for (int src = 1; src < size; src++)
+      for (int round = NB_ROUNDS / 2; round < NB_ROUNDS; round++) {
+        for (int tag = 0; tag < NB_TAGS - 1; tag++) {
+          if (tag == NB_TAGS / 2 && round < next_round[src])
+            continue;
+          MPI_Recv(&value, 1, MPI_INT, src, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+          check(rank, value, payload(src, round, tag), "any tag");
+          check(rank, status.MPI_TAG, tag, "tag of any tag");
+          count++;
+        }
+        MPI_Recv(&value, 1, MPI_INT, src, NB_TAGS - 1, MPI_COMM_WORLD, &status);
+        check(rank, value, payload(src, round, NB_TAGS - 1), "last tag");
+        count++;
+      }
+    printf("rank 0: %d messages received in order\n", count);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -13,6 +13,7 @@
 #include "xbt/sysdep.h"
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(surf_test, "Messages specific for surf example");
 
@@ -25,7 +26,7 @@ using namespace simgrid::kernel;
 /*  ==l1==  L2  ==L3==           */
 /*        ------                 */
 
-enum method_t { MAXMIN, LAGRANGE_RENO, LAGRANGE_VEGAS };
+enum method_t { MAXMIN, FLAT_MAXMIN, LAGRANGE_RENO, LAGRANGE_VEGAS };
 
 static lmm::System* new_system(method_t method)
 {
@@ -33,6 +34,8 @@ static lmm::System* new_system(method_t method)
   switch (method) {
     case MAXMIN:
       return lmm::make_new_maxmin_system(false);
+    case FLAT_MAXMIN:
+      return lmm::make_new_flat_maxmin_system(false);
     case LAGRANGE_VEGAS:
     case LAGRANGE_RENO:
       return lmm::make_new_lagrange_system(false);
@@ -132,7 +135,7 @@ static void test1(method_t method)
   Sys->expand(L2, R_2, 1.0);
   Sys->expand(L3, R_3, 1.0);
 
-  if (method == MAXMIN) {
+  if (method == MAXMIN || method == FLAT_MAXMIN) {
     Sys->solve();
   } else {
     double x;
@@ -296,11 +299,72 @@ static void test3(method_t method)
   delete[] A;
 }
 
+/* Several independent copies of the system of test1, with bounds and weights that are not exactly representable */
+static std::vector<double> solve_test4(bool split_components)
+{
+  bool saved_split           = sg_maxmin_split_components;
+  sg_maxmin_split_components = split_components;
+
+  lmm::System* Sys = new_system(MAXMIN);
+  std::vector<lmm::Variable*> vars;
+  for (int k = 0; k < 4; k++) {
+    lmm::Constraint* L1 = Sys->constraint_new(nullptr, 1.0 + k / 7.0);
+    lmm::Constraint* L2 = Sys->constraint_new(nullptr, 10.0 / 3.0 + k / 11.0);
+    lmm::Constraint* L3 = Sys->constraint_new(nullptr, 1.0 + k / 13.0);
+
+    lmm::Variable* R_1_2_3 = Sys->variable_new(nullptr, 1.0 + k / 3.0, -1.0, 3);
+    lmm::Variable* R_1     = Sys->variable_new(nullptr, 1.0, -1.0, 1);
+    lmm::Variable* R_2     = Sys->variable_new(nullptr, 1.0 / 3.0, -1.0, 1);
+    lmm::Variable* R_3     = Sys->variable_new(nullptr, 1.0, 0.1 + k / 9.0, 1);
+
+    Sys->expand(L1, R_1_2_3, 1.0);
+    Sys->expand(L2, R_1_2_3, 1.0);
+    Sys->expand(L3, R_1_2_3, 1.0);
+    Sys->expand(L1, R_1, 1.0);
+    Sys->expand(L2, R_2, 1.0);
+    Sys->expand(L3, R_3, 1.0);
+    vars.insert(vars.end(), {R_1_2_3, R_1, R_2, R_3});
+  }
+
+  Sys->solve();
+
+  std::vector<double> values;
+  for (lmm::Variable* var : vars) {
+    values.push_back(var->get_value());
+    Sys->variable_free(var);
+  }
+  delete Sys;
+  sg_maxmin_split_components = saved_split;
+  return values;
+}
+
+/* Compares the values computed with the current settings to the ones of the global resolution */
+static void test4()
+{
+  std::vector<double> reference = solve_test4(false);
+  std::vector<double> values    = solve_test4(sg_maxmin_split_components);
+
+  for (unsigned i = 0; i < values.size(); i++)
+    XBT_INFO("Component %u, variable %u: %g", i / 4, i % 4, values[i]);
+
+  if (not sg_maxmin_split_components) {
+    xbt_assert(values == reference, "The values differ from the global resolution");
+    XBT_INFO("Same values as the global resolution");
+  } else {
+    for (unsigned i = 0; i < values.size(); i++)
+      xbt_assert(double_equals(values[i], reference[i], sg_maxmin_precision),
+                 "Variable %u differs from the global resolution: %.17g instead of %.17g", i, values[i], reference[i]);
+    XBT_INFO("Same values as the global resolution, up to the maxmin precision");
+  }
+}
+
 int main(int argc, char** argv)
 {
   MSG_init(&argc, argv);
   XBT_INFO("***** Test 1 (Max-Min)");
   test1(MAXMIN);
+  XBT_INFO("***** Test 1 (Flat Max-Min)");
+  test1(FLAT_MAXMIN);
   XBT_INFO("***** Test 1 (Lagrange - Vegas)");
   test1(LAGRANGE_VEGAS);
   XBT_INFO("***** Test 1 (Lagrange - Reno)");
@@ -308,6 +372,8 @@ int main(int argc, char** argv)
 
   XBT_INFO("***** Test 2 (Max-Min)");
   test2(MAXMIN);
+  XBT_INFO("***** Test 2 (Flat Max-Min)");
+  test2(FLAT_MAXMIN);
   XBT_INFO("***** Test 2 (Lagrange - Vegas)");
   test2(LAGRANGE_VEGAS);
   XBT_INFO("***** Test 2 (Lagrange - Reno)");
@@ -315,10 +381,15 @@ int main(int argc, char** argv)
 
   XBT_INFO("***** Test 3 (Max-Min)");
   test3(MAXMIN);
+  XBT_INFO("***** Test 3 (Flat Max-Min)");
+  test3(FLAT_MAXMIN);
   XBT_INFO("***** Test 3 (Lagrange - Vegas)");
   test3(LAGRANGE_VEGAS);
   XBT_INFO("***** Test 3 (Lagrange - Reno)");
   test3(LAGRANGE_RENO);
 
+  XBT_INFO("***** Test 4 (Max-Min, independent components)");
+  test4();
+
   return 0;
 }
@@ -300,6 +300,7 @@ set(NS3_SRC  src/surf/network_ns3.cpp
 
 set(SURF_SRC
   src/kernel/lmm/fair_bottleneck.cpp
+  src/kernel/lmm/flat_maxmin.cpp
   src/kernel/lmm/lagrange.cpp
   src/kernel/lmm/maxmin.hpp
   src/kernel/lmm/maxmin.cpp
@@ -374,6 +375,8 @@ set(SIMIX_SRC
   src/kernel/context/Context.hpp
   src/kernel/context/ContextRaw.cpp
   src/kernel/context/ContextRaw.hpp
+  src/kernel/context/ContextShared.cpp
+  src/kernel/context/ContextShared.hpp
   src/simix/smx_deployment.cpp
   src/simix/smx_environment.cpp
   src/simix/smx_global.cpp
@@ -552,6 +555,8 @@ set(TRACING_SRC
   src/instr/instr_private.hpp
   src/instr/instr_smpi.hpp
   src/instr/instr_resource_utilization.cpp
+  src/instr/instr_trace_writer.cpp
+  src/instr/instr_trace_writer.hpp
   )
 
 set(JEDULE_SRC
@@ -1042,6 +1047,7 @@ set(CMAKEFILES_TXT
 
   tools/CMakeLists.txt
   tools/graphicator/CMakeLists.txt
+  tools/replay-convert/CMakeLists.txt
   tools/tesh/CMakeLists.txt
   )
 
@@ -0,0 +1,21 @@
+/* Copyright (c) 2018. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "xbt/asserts.h"
+#include "xbt/log.h"
+#include "xbt/replay.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(replay_convert, "Replay trace converter");
+
+int main(int argc, char** argv)
+{
+  xbt_log_init(&argc, argv);
+  xbt_assert(argc == 3, "Usage: %s <textual_trace> <binary_trace>\n"
+                        "\tConverts a replay trace (MSG, S4U or SMPI time-independent) into the binary format",
+             argv[0]);
+
+  simgrid::xbt::replay_convert_to_binary(argv[1], argv[2]);
+  return 0;
+}